@@ -0,0 +1,210 @@
+// STD
+#include <algorithm>
+#include <array>
+
+// VM
+#include "block_cache.hpp"
+#include "virtual_memory.hpp"
+
+// x86
+#include "disasm.hpp"
+#include "instruction_dispatch.hpp"
+
+namespace
+{
+	std::uint8_t* page_of(std::uint8_t* address)
+	{
+		return reinterpret_cast<std::uint8_t*>(
+			reinterpret_cast<std::uintptr_t>(address) & ~(vm::virtual_memory::page_size - 1));
+	}
+
+	// DECODE ONE INSTRUCTION, OVERLAYING GUEST-MAPPED PAGES ON THE HOST CODE
+	void fetch_decode(vm::virtual_memory& memory, x86::instruction& instr, std::uint8_t*& instruction_pointer, size_t remaining)
+	{
+		const auto size = std::min(remaining, x86::disassembler::max_decode_read);
+		const auto first_page = page_of(instruction_pointer);
+		const auto last_page = page_of(instruction_pointer + size - 1);
+
+		if (!memory.mapped(first_page) && !memory.mapped(last_page))
+		{
+			x86::disassembler::decode(instr, instruction_pointer, remaining);
+			return;
+		}
+
+		std::array<std::uint8_t, x86::disassembler::max_decode_read> window{};
+		for (size_t offset = 0; offset < size;)
+		{
+			const auto current = instruction_pointer + offset;
+			const auto length = std::min(size - offset, static_cast<size_t>(page_of(current) + vm::virtual_memory::page_size - current));
+
+			if (memory.mapped(current))
+				memory.read_block(current, window.data() + offset, length);
+			else
+				std::copy_n(current, length, window.data() + offset);
+
+			offset += length;
+		}
+
+		auto pointer = window.data();
+		x86::disassembler::decode(instr, pointer, size);
+		instruction_pointer += pointer - window.data();
+	}
+}
+
+vm::basic_block* vm::block_cache::find(std::uint8_t* address)
+{
+	const auto search = this->blocks().find(address);
+	if (search == this->blocks().end())
+		return nullptr;
+
+	return &search->second;
+}
+
+vm::basic_block& vm::block_cache::build(std::uint8_t* address, std::uint8_t* buffer_end, vm::virtual_memory& memory)
+{
+	vm::basic_block block{};
+	block.start = address;
+	block.end = address;
+	block.instructions.reserve(vm::block_cache::max_block_instructions);
+
+	
+	auto instruction_pointer = address;
+	while (instruction_pointer < buffer_end &&
+		block.instructions.size() < vm::block_cache::max_block_instructions)
+	{
+		auto& instr = block.instructions.emplace_back();
+		fetch_decode(memory, instr, instruction_pointer, static_cast<size_t>(buffer_end - instruction_pointer));
+
+		
+		if (x86::dispatch::ends_block(instr.handler()))
+		{
+			switch (instr.handler())
+			{
+			case x86::dispatch::call:	block.exit = vm::block_exit::call; break;
+			case x86::dispatch::ret:	block.exit = vm::block_exit::ret; break;
+			default:					block.exit = vm::block_exit::branch; break;
+			}
+
+			break;
+		}
+	}
+
+	block.end = instruction_pointer;
+	block.instructions.shrink_to_fit();
+
+	
+	for (auto page = page_of(block.start); page < block.end; page += vm::virtual_memory::page_size)
+		this->pages()[page].push_back(address);
+
+	return this->blocks().insert_or_assign(address, std::move(block)).first->second;
+}
+
+void vm::block_cache::link(vm::basic_block& from, vm::basic_block*& exit, vm::basic_block& to)
+{
+	// A STALE LINK (E.G. AFTER A FAULT HANDLER REDIRECTED EXECUTION) IS REPLACED, NOT STACKED
+	if (exit != nullptr)
+	{
+		auto& previous = exit->incoming;
+		previous.erase(std::find(previous.begin(), previous.end(), &from));
+	}
+
+	exit = &to;
+	to.incoming.push_back(&from);
+}
+
+void vm::block_cache::unlink(vm::basic_block& block)
+{
+	for (const auto predecessor : block.incoming)
+	{
+		if (predecessor->taken == &block)
+			predecessor->taken = nullptr;
+
+		if (predecessor->fallthrough == &block)
+			predecessor->fallthrough = nullptr;
+	}
+	block.incoming.clear();
+
+	for (const auto successor : { block.taken, block.fallthrough })
+	{
+		if (successor != nullptr)
+			std::erase(successor->incoming, &block);
+	}
+
+	block.taken = nullptr;
+	block.fallthrough = nullptr;
+}
+
+size_t vm::block_cache::invalidate_page(std::uint8_t* page)
+{
+	const auto search = this->pages().find(page_of(page));
+	if (search == this->pages().end())
+		return 0;
+
+	const auto starts = std::move(search->second);
+	this->pages().erase(search);
+
+	size_t dropped = 0;
+	for (const auto start : starts)
+	{
+		const auto block = this->blocks().find(start);
+		if (block == this->blocks().end())
+			continue;
+
+		// UNLINK FROM THE OTHER PAGES A BLOCK STRADDLES
+		for (auto other = page_of(block->second.start); other < block->second.end; other += vm::virtual_memory::page_size)
+		{
+			const auto list = this->pages().find(other);
+			if (list == this->pages().end())
+				continue;
+
+			std::erase(list->second, start);
+			if (list->second.empty())
+				this->pages().erase(list);
+		}
+
+		this->unlink(block->second);
+
+		// THE INSTRUCTION STORAGE MOVES WITH THE BLOCK, POINTERS INTO IT STAY VALID
+		this->m_retired.push_back(std::move(block->second));
+		this->blocks().erase(block);
+		++dropped;
+	}
+
+	if (dropped != 0)
+		++this->m_epoch;
+
+	return dropped;
+}
+
+void vm::block_cache::release_retired()
+{
+	this->m_retired.clear();
+}
+
+void vm::block_cache::clear()
+{
+	this->blocks().clear();
+	this->pages().clear();
+	this->m_retired.clear();
+	++this->m_epoch;
+}
+
+size_t vm::block_cache::size()
+{
+	return this->blocks().size();
+}
+
+std::uint64_t vm::block_cache::epoch() const
+{
+	return this->m_epoch;
+}
+
+vm::block_cache::block_map_t& vm::block_cache::blocks()
+{
+	return this->m_blocks;
+}
+
+vm::block_cache::page_map_t& vm::block_cache::pages()
+{
+	return this->m_pages;
+}
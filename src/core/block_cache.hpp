@@ -0,0 +1,92 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// x86
+#include "instruction.hpp"
+
+namespace vm
+{
+	class virtual_memory;
+
+	// HOW CONTROL LEAVES A BLOCK
+	enum class block_exit : std::uint8_t
+	{
+		// SIZE LIMIT OR END OF CODE, ONLY THE FALLTHROUGH EXIT EXISTS
+		fallthrough,
+
+		// JMP/JCC, THE TAKEN TARGET IS FIXED BY THE INSTRUCTION BYTES
+		branch,
+
+		// CALL, THE RETURN SITE IS THE FALLTHROUGH EXIT
+		call,
+
+		// RET, THE TARGET COMES FROM GUEST STATE SO TAKEN IS NEVER LINKED
+		ret
+	};
+
+	// STRAIGHT-LINE RUN OF DECODED INSTRUCTIONS
+	struct basic_block
+	{
+		std::uint8_t* start;
+		std::uint8_t* end;
+		std::vector<x86::instruction> instructions;
+
+		// SUCCESSORS, LINKED THE FIRST TIME EACH EXIT IS TAKEN
+		vm::basic_block* taken = nullptr;
+		vm::basic_block* fallthrough = nullptr;
+
+		// BLOCKS WHOSE TAKEN OR FALLTHROUGH LINK POINTS HERE, UNLINKED WHEN THIS BLOCK IS DROPPED
+		std::vector<vm::basic_block*> incoming;
+
+		vm::block_exit exit = vm::block_exit::fallthrough;
+	};
+
+	// PER-VM CACHE OF DECODED BLOCKS, KEYED BY GUEST ADDRESS
+	class block_cache
+	{
+	public:
+		static constexpr size_t max_block_instructions = 0x40;
+
+		
+		vm::basic_block* find(std::uint8_t* address);
+
+		// DECODES [ADDRESS, BUFFER_END) FROM THE HOST CODE, EXCEPT WHERE GUEST MEMORY IS MAPPED OVER IT:
+		// THOSE BYTES ARE FETCHED THROUGH MEMORY, SO CODE THE GUEST WROTE IS WHAT GETS DECODED
+		vm::basic_block& build(std::uint8_t* address, std::uint8_t* buffer_end, vm::virtual_memory& memory);
+
+		// POINT ONE OF FROM'S EXITS (TAKEN OR FALLTHROUGH) AT TO
+		void link(vm::basic_block& from, vm::basic_block*& exit, vm::basic_block& to);
+
+		// DROP EVERY BLOCK WITH BYTES ON THE PAGE, RETURNS HOW MANY WERE DROPPED
+		// DROPPED BLOCKS STAY ALIVE UNTIL RELEASE_RETIRED SO A RUNNING BLOCK CAN FINISH ITS INSTRUCTION
+		size_t invalidate_page(std::uint8_t* page);
+		void release_retired();
+
+		void clear();
+		size_t size();
+
+		// BUMPED WHENEVER BLOCKS ARE DROPPED, BLOCK POINTERS HELD OUTSIDE THE LINKS ARE ONLY
+		// VALID WHILE THE EPOCH THEY WERE TAKEN IN IS CURRENT
+		std::uint64_t epoch() const;
+
+	private:
+		// DETACH EVERY LINK INTO AND OUT OF THE BLOCK
+		void unlink(vm::basic_block& block);
+
+		using block_map_t = std::unordered_map<std::uint8_t*, vm::basic_block>;
+		block_map_t& blocks();
+
+		// GUEST PAGE -> START OF EVERY CACHED BLOCK TOUCHING IT
+		using page_map_t = std::unordered_map<std::uint8_t*, std::vector<std::uint8_t*>>;
+		page_map_t& pages();
+
+		block_map_t m_blocks;
+		page_map_t m_pages;
+		std::vector<vm::basic_block> m_retired;
+		std::uint64_t m_epoch = 0;
+	};
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// STD
+#include <cstdint>
+
+namespace vm
+{
+	enum class fault_code : std::uint8_t
+	{
+		none,
+		page_fault,
+		invalid_opcode,
+		general_protection,
+		stack_fault,
+
+		// CONTROL TRANSFER OUTSIDE THE CODE, THE ADDRESS IS THE TARGET
+		invalid_target
+	};
+
+	inline const char* to_string(vm::fault_code code)
+	{
+		switch (code)
+		{
+		case vm::fault_code::none:					return "None";
+		case vm::fault_code::page_fault:			return "Pagefault";
+		case vm::fault_code::invalid_opcode:		return "Invalid opcode";
+		case vm::fault_code::general_protection:	return "General protection";
+		case vm::fault_code::stack_fault:			return "Stack fault";
+		case vm::fault_code::invalid_target:		return "Invalid branch target";
+		}
+
+		return "Unknown fault";
+	}
+
+	// RETURNED UP THROUGH MEMORY ACCESSES AND HANDLERS INSTEAD OF THROWING
+	struct fault
+	{
+		vm::fault_code code;
+
+		// FAULTING DATA ADDRESS, OR THE INSTRUCTION ITSELF FOR DECODE FAULTS
+		// ALWAYS SET BY WHOEVER RAISES THE FAULT, NULLPTR IS A VALID GUEST ADDRESS
+		std::uint8_t* address;
+
+		// START OF THE FAULTING INSTRUCTION, FILLED IN BY THE RUN LOOP
+		std::uint8_t* instruction;
+
+		explicit operator bool() const
+		{
+			return this->code != vm::fault_code::none;
+		}
+	};
+
+	// WHAT THE RUN LOOP DOES AFTER A FAULT HAS BEEN DELIVERED
+	enum class fault_action : std::uint8_t
+	{
+		// RE-EXECUTE THE FAULTING INSTRUCTION, E.G. AFTER MAPPING THE PAGE
+		retry,
+
+		// CONTINUE AT THE CURRENT INSTRUCTION POINTER
+		skip,
+
+		// LEAVE THE RUN LOOP
+		stop
+	};
+}
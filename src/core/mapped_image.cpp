@@ -0,0 +1,144 @@
+// STD
+#include <utility>
+
+// VM
+#include "mapped_image.hpp"
+#include "exceptions.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+vm::mapped_image::mapped_image(const std::string& path)
+{
+#if defined(_WIN32)
+	this->m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->m_file == INVALID_HANDLE_VALUE)
+	{
+		this->m_file = nullptr;
+		throw vm::vm_exception("Failed to open image " + path);
+	}
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(this->m_file, &size))
+	{
+		this->unmap();
+		throw vm::vm_exception("Failed to query image size " + path);
+	}
+
+	this->m_size = static_cast<size_t>(size.QuadPart);
+
+	// EMPTY FILES CANNOT BE MAPPED, AN EMPTY VIEW IS FINE
+	if (this->m_size == 0)
+		return;
+
+	this->m_mapping = CreateFileMappingA(this->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (this->m_mapping == nullptr)
+	{
+		this->unmap();
+		throw vm::vm_exception("Failed to map image " + path);
+	}
+
+	this->m_data = static_cast<const std::uint8_t*>(MapViewOfFile(this->m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (this->m_data == nullptr)
+	{
+		this->unmap();
+		throw vm::vm_exception("Failed to map image " + path);
+	}
+#else
+	const auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		throw vm::vm_exception("Failed to open image " + path);
+
+	struct stat status{};
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw vm::vm_exception("Failed to query image size " + path);
+	}
+
+	this->m_size = static_cast<size_t>(status.st_size);
+
+	// EMPTY FILES CANNOT BE MAPPED, AN EMPTY VIEW IS FINE
+	if (this->m_size == 0)
+	{
+		close(file);
+		return;
+	}
+
+	const auto data = mmap(nullptr, this->m_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	// THE MAPPING KEEPS ITS OWN REFERENCE TO THE FILE
+	close(file);
+
+	if (data == MAP_FAILED)
+		throw vm::vm_exception("Failed to map image " + path);
+
+	this->m_data = static_cast<const std::uint8_t*>(data);
+#endif
+}
+
+vm::mapped_image::~mapped_image()
+{
+	this->unmap();
+}
+
+vm::mapped_image::mapped_image(vm::mapped_image&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+vm::mapped_image& vm::mapped_image::operator=(vm::mapped_image&& other) noexcept
+{
+	if (this != &other)
+	{
+		this->unmap();
+
+		this->m_data = std::exchange(other.m_data, nullptr);
+		this->m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN32)
+		this->m_file = std::exchange(other.m_file, nullptr);
+		this->m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+	}
+
+	return *this;
+}
+
+vm::code_view vm::mapped_image::view() const
+{
+	return vm::code_view(this->m_data, this->m_size);
+}
+
+size_t vm::mapped_image::size() const
+{
+	return this->m_size;
+}
+
+void vm::mapped_image::unmap()
+{
+#if defined(_WIN32)
+	if (this->m_data != nullptr)
+		UnmapViewOfFile(this->m_data);
+
+	if (this->m_mapping != nullptr)
+		CloseHandle(this->m_mapping);
+
+	if (this->m_file != nullptr)
+		CloseHandle(this->m_file);
+
+	this->m_file = nullptr;
+	this->m_mapping = nullptr;
+#else
+	if (this->m_data != nullptr)
+		munmap(const_cast<std::uint8_t*>(this->m_data), this->m_size);
+#endif
+
+	this->m_data = nullptr;
+	this->m_size = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace vm
+{
+	// NON-OWNING VIEW OF GUEST CODE, THE CALLER KEEPS THE STORAGE ALIVE
+	using code_view = std::span<const std::uint8_t>;
+
+	// READ-ONLY MAPPING OF AN IMAGE FILE, PAGES ARE FAULTED IN BY THE HOST ON FIRST USE
+	class mapped_image
+	{
+	public:
+		explicit mapped_image(const std::string& path);
+		~mapped_image();
+
+		mapped_image(const mapped_image&) = delete;
+		mapped_image& operator=(const mapped_image&) = delete;
+
+		mapped_image(mapped_image&& other) noexcept;
+		mapped_image& operator=(mapped_image&& other) noexcept;
+
+		
+		vm::code_view view() const;
+		size_t size() const;
+
+	private:
+		void unmap();
+
+		const std::uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+
+#if defined(_WIN32)
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+}
@@ -1,4 +1,5 @@
 #include "register.hpp"
+#include "numerical_helper.hpp"
 
 const x86::registr::register_name_map_t x86::registr::names =
 {
@@ -37,5 +38,74 @@ std::uint8_t*& x86::registr::instruction_pointer()
 
 x86::registr::flags_t& x86::registr::flags()
 {
+	if (this->m_lazy_flags.operation != x86::registr::operation::none)
+		this->materialise_flags();
+
 	return this->m_flags;
 }
+
+bool x86::registr::condition(std::uint8_t code)
+{
+	const auto& flags = this->flags();
+
+	bool result = false;
+	switch (code >> 1)
+	{
+	case 0: result = flags.overflow; break;								// O
+	case 1: result = flags.carry; break;								// B
+	case 2: result = flags.zero; break;									// E
+	case 3: result = flags.carry || flags.zero; break;					// BE
+	case 4: result = flags.sign; break;									// S
+	case 5: result = flags.parity; break;								// P
+	case 6: result = flags.sign != flags.overflow; break;				// L
+	case 7: result = flags.zero || flags.sign != flags.overflow; break;	// LE
+	}
+
+	// ODD CODES ARE THE NEGATED FORM
+	return (code & 0x01) ? !result : result;
+}
+
+void x86::registr::materialise_flags()
+{
+	auto& lazy = this->m_lazy_flags;
+	auto& flags = this->m_flags;
+
+	
+	const auto bit_count = lazy.size * 8;
+	const auto mask = bit_count == 64 ? ~0ull : (1ull << bit_count) - 1;
+	const auto sign_bit = 1ull << (bit_count - 1);
+
+	const auto destination = lazy.destination & mask;
+	const auto source = lazy.source & mask;
+	const auto result = lazy.result & mask;
+
+	switch (lazy.operation)
+	{
+	case x86::registr::operation::add:
+		flags.carry = result < destination;
+		flags.overflow = ((destination ^ result) & (source ^ result) & sign_bit) != 0;
+		flags.auxiliary_carry = ((destination ^ source ^ result) & 0x10) != 0;
+		break;
+
+	case x86::registr::operation::sub:
+		flags.carry = destination < source;
+		flags.overflow = ((destination ^ source) & (destination ^ result) & sign_bit) != 0;
+		flags.auxiliary_carry = ((destination ^ source ^ result) & 0x10) != 0;
+		break;
+
+	case x86::registr::operation::logic:
+		flags.carry = 0;
+		flags.overflow = 0;
+		flags.auxiliary_carry = 0;
+		break;
+
+	default:
+		return;
+	}
+
+	flags.zero = result == 0;
+	flags.sign = (result & sign_bit) != 0;
+	flags.parity = numerical_helper::parity(result);
+
+	lazy.operation = x86::registr::operation::none;
+}
@@ -2,6 +2,8 @@
 
 // STD
 #include <array>
+#include <cstdint>
+#include <string>
 
 namespace x86
 {
@@ -133,14 +135,46 @@ namespace x86
 			std::uint8_t reserved_31 : 1; 
 		};
 
+		// LAST FLAG-PRODUCING OPERATION, EVALUATED ON DEMAND
+		enum class operation : std::uint8_t
+		{
+			none,
+			add,
+			sub,
+			logic
+		};
+
+		struct lazy_flags_t
+		{
+			std::uint64_t destination;
+			std::uint64_t source;
+			std::uint64_t result;
+			x86::registr::operation operation;
+			std::uint8_t size;
+		};
+
 		
 		x86::registr::register_data& get(std::uint8_t id);
 
 		std::uint8_t*& instruction_pointer();
 
-		
+		// MATERIALISES PENDING LAZY FLAGS FIRST
 		flags_t& flags();
 
+		// JCC/SETCC/CMOVCC CONDITION CODE (LOW NIBBLE OF THE OPCODE)
+		bool condition(std::uint8_t code);
+
+		// RECORD CF/ZF/SF/OF/PF/AF INPUTS WITHOUT COMPUTING THEM
+		template <class T>
+		void record_flags(x86::registr::operation operation, T destination, T source, T result)
+		{
+			this->m_lazy_flags.destination = destination;
+			this->m_lazy_flags.source = source;
+			this->m_lazy_flags.result = result;
+			this->m_lazy_flags.operation = operation;
+			this->m_lazy_flags.size = sizeof(T);
+		}
+
 	
 		using data_t = std::array<x86::registr::register_data, x86::registr::id::END_OF_REGISTER>;
 		data_t& general_buffer();
@@ -150,9 +184,12 @@ namespace x86
 		static const register_name_map_t names;
 
 	private:
+		void materialise_flags();
+
 		data_t m_general_buffer;
 		std::uint8_t* m_instruction_pointer;
-		flags_t m_flags;
+		flags_t m_flags{};
+		lazy_flags_t m_lazy_flags{};
 
 	};
 }
\ No newline at end of file
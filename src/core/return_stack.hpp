@@ -0,0 +1,65 @@
+#pragma once
+
+// STD
+#include <array>
+#include <cstdint>
+
+// VM
+#include "block_cache.hpp"
+
+namespace vm
+{
+	// SHADOW OF THE GUEST CALL STACK, PREDICTS RET TARGETS WITHOUT A BLOCK LOOKUP
+	// OVERFLOW OVERWRITES THE OLDEST ENTRY, A MISPREDICTION ONLY COSTS THE NORMAL LOOKUP
+	class return_stack
+	{
+	public:
+		static constexpr size_t depth = 0x20;
+		static_assert((depth & (depth - 1)) == 0, "depth must be a power of two");
+
+		struct entry
+		{
+			std::uint8_t* return_address;
+
+			// BLOCK ENDING IN THE CALL, ITS FALLTHROUGH LINK IS THE RETURN SITE
+			vm::basic_block* caller;
+
+			// BLOCK CACHE EPOCH WHEN PUSHED, CALLER MAY BE GONE ONCE IT CHANGES
+			std::uint64_t epoch;
+		};
+
+		void push(vm::basic_block& caller, std::uint64_t epoch)
+		{
+			this->m_entries[this->m_top++ & (depth - 1)] = { caller.end, &caller, epoch };
+
+			if (this->m_count < depth)
+				++this->m_count;
+		}
+
+		// CALLER OF THE MATCHING CALL, NULLPTR ON A MISPREDICTION, UNDERFLOW OR STALE ENTRY
+		vm::basic_block* pop(std::uint8_t* return_address, std::uint64_t epoch)
+		{
+			if (this->m_count == 0)
+				return nullptr;
+
+			--this->m_count;
+			const auto& entry = this->m_entries[--this->m_top & (depth - 1)];
+
+			if (entry.return_address != return_address || entry.epoch != epoch)
+				return nullptr;
+
+			return entry.caller;
+		}
+
+		void clear()
+		{
+			this->m_top = 0;
+			this->m_count = 0;
+		}
+
+	private:
+		std::array<entry, depth> m_entries{};
+		size_t m_top = 0;
+		size_t m_count = 0;
+	};
+}
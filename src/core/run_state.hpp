@@ -0,0 +1,33 @@
+#pragma once
+
+// STD
+#include <cstdint>
+
+namespace vm
+{
+	enum class run_status : std::uint8_t
+	{
+		// BUDGET OR DEADLINE RAN OUT, CALL RUN_FOR AGAIN TO RESUME AT THE INSTRUCTION POINTER
+		suspended,
+
+		// EXECUTION LEFT THE END OF THE CODE BUFFER
+		finished,
+
+		// A FAULT STOPPED THE RUN, SEE LAST_FAULT
+		faulted
+	};
+
+	// RESULT OF ONE RUN SLICE, THE GUEST STATE ITSELF STAYS IN THE VIRTUAL MACHINE
+	struct run_state
+	{
+		vm::run_status status;
+
+		// INSTRUCTIONS EXECUTED, COUNTED PER BLOCK SO A BLOCK LEFT EARLY IS STILL CHARGED IN FULL
+		std::uint64_t instructions;
+
+		bool resumable() const
+		{
+			return this->status == vm::run_status::suspended;
+		}
+	};
+}
@@ -0,0 +1,226 @@
+// STD
+#include <algorithm>
+
+// VM
+#include "scheduler.hpp"
+#include "virtual_machine.hpp"
+
+virtual_machine& vm::scheduled_vm::machine()
+{
+	return this->m_machine;
+}
+
+bool vm::scheduled_vm::done() const
+{
+	std::lock_guard<std::mutex> lock(this->m_done_mutex);
+	return this->m_done;
+}
+
+void vm::scheduled_vm::wait()
+{
+	std::unique_lock<std::mutex> lock(this->m_done_mutex);
+	this->m_done_condition.wait(lock, [this]() { return this->m_done; });
+}
+
+vm::run_state vm::scheduled_vm::result() const
+{
+	std::lock_guard<std::mutex> lock(this->m_done_mutex);
+	return this->m_result;
+}
+
+std::chrono::nanoseconds vm::scheduled_vm::cpu_time() const
+{
+	return std::chrono::nanoseconds(this->m_cpu_time.load(std::memory_order_relaxed));
+}
+
+std::uint64_t vm::scheduled_vm::instructions() const
+{
+	return this->m_instructions.load(std::memory_order_relaxed);
+}
+
+std::uint64_t vm::scheduled_vm::slices() const
+{
+	return this->m_slices.load(std::memory_order_relaxed);
+}
+
+size_t vm::scheduled_vm::worker() const
+{
+	return this->m_worker.load(std::memory_order_relaxed);
+}
+
+void vm::scheduled_vm::complete(vm::run_state state)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_done_mutex);
+		this->m_result = state;
+		this->m_result.instructions = this->instructions();
+		this->m_done = true;
+	}
+
+	this->m_done_condition.notify_all();
+}
+
+vm::scheduler::scheduler(size_t workers, std::uint64_t slice) : m_slice(slice)
+{
+	// HARDWARE_CONCURRENCY MAY REPORT ZERO
+	const auto count = std::max<size_t>(workers, 1);
+
+	for (size_t i = 0; i < count; i++)
+		this->m_queues.push_back(std::make_unique<worker_queue>());
+
+	for (size_t i = 0; i < count; i++)
+		this->m_workers.emplace_back([this, i]() { this->worker_loop(i); });
+}
+
+vm::scheduler::~scheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_idle_mutex);
+		this->m_stop.store(true, std::memory_order_release);
+	}
+	this->m_work_available.notify_all();
+
+	for (auto& worker : this->m_workers)
+		worker.join();
+
+	// WAKE ANYONE STILL WAITING ON GUESTS THAT NEVER GOT TO FINISH, OR ON THE SCHEDULER GOING IDLE
+	for (auto& queue : this->m_queues)
+	{
+		for (auto& job : queue->jobs)
+		{
+			job->complete(vm::run_state{ vm::run_status::suspended, 0 });
+			this->m_active.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_idle_mutex);
+	}
+	this->m_all_done.notify_all();
+}
+
+std::shared_ptr<vm::scheduled_vm> vm::scheduler::submit(virtual_machine& machine)
+{
+	auto job = std::make_shared<vm::scheduled_vm>(machine);
+
+	
+	const auto index = this->m_next_queue.fetch_add(1, std::memory_order_relaxed) % this->m_queues.size();
+	job->m_worker.store(index, std::memory_order_relaxed);
+
+	this->m_active.fetch_add(1, std::memory_order_relaxed);
+	this->push(index, job);
+
+	{
+		// PAIRS WITH THE PREDICATE CHECK IN WORKER_LOOP SO THE WAKE-UP CANNOT BE LOST
+		std::lock_guard<std::mutex> lock(this->m_idle_mutex);
+	}
+	this->m_work_available.notify_one();
+
+	return job;
+}
+
+void vm::scheduler::wait_idle()
+{
+	std::unique_lock<std::mutex> lock(this->m_idle_mutex);
+	this->m_all_done.wait(lock, [this]() { return this->m_active.load(std::memory_order_acquire) == 0; });
+}
+
+size_t vm::scheduler::worker_count() const
+{
+	return this->m_queues.size();
+}
+
+void vm::scheduler::worker_loop(size_t index)
+{
+	while (!this->m_stop.load(std::memory_order_acquire))
+	{
+		auto job = this->pop(index);
+		if (job == nullptr)
+			job = this->steal(index);
+
+		if (job == nullptr)
+		{
+			std::unique_lock<std::mutex> lock(this->m_idle_mutex);
+			this->m_work_available.wait(lock, [this]()
+			{
+				return this->m_stop.load(std::memory_order_acquire) || this->m_queued.load(std::memory_order_acquire) != 0;
+			});
+
+			continue;
+		}
+
+		
+		const auto start = std::chrono::steady_clock::now();
+		const auto state = job->machine().run_for(this->m_slice);
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+
+		job->m_cpu_time.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+		job->m_instructions.fetch_add(state.instructions, std::memory_order_relaxed);
+		job->m_slices.fetch_add(1, std::memory_order_relaxed);
+
+		if (state.resumable())
+		{
+			// BACK ONTO THIS WORKER, ITS CODE AND BLOCK CACHE ARE STILL WARM HERE
+			this->push(index, std::move(job));
+			continue;
+		}
+
+		job->complete(state);
+
+		if (this->m_active.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard<std::mutex> lock(this->m_idle_mutex);
+			this->m_all_done.notify_all();
+		}
+	}
+}
+
+void vm::scheduler::push(size_t index, job_t job)
+{
+	auto& queue = *this->m_queues[index];
+
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	queue.jobs.push_back(std::move(job));
+	this->m_queued.fetch_add(1, std::memory_order_release);
+}
+
+vm::scheduler::job_t vm::scheduler::pop(size_t index)
+{
+	auto& queue = *this->m_queues[index];
+
+	// OWNER TAKES THE OLDEST GUEST, SLICES ROTATE ROUND-ROBIN
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+		return nullptr;
+
+	auto job = std::move(queue.jobs.front());
+	queue.jobs.pop_front();
+	this->m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+	return job;
+}
+
+vm::scheduler::job_t vm::scheduler::steal(size_t thief)
+{
+	const auto count = this->m_queues.size();
+
+	for (size_t i = 1; i < count; i++)
+	{
+		const auto victim = (thief + i) % count;
+		auto& queue = *this->m_queues[victim];
+
+		// THIEVES TAKE FROM THE BACK, THE GUEST THE VICTIM WOULD HAVE REACHED LAST
+		std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+		if (!lock.owns_lock() || queue.jobs.empty())
+			continue;
+
+		auto job = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+		this->m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+		job->m_worker.store(thief, std::memory_order_relaxed);
+		return job;
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// VM
+#include "run_state.hpp"
+
+class virtual_machine;
+
+namespace vm
+{
+	// ONE GUEST OWNED BY THE SCHEDULER UNTIL IT FINISHES OR FAULTS
+	class scheduled_vm
+	{
+	public:
+		explicit scheduled_vm(virtual_machine& machine) : m_machine(machine) {}
+
+		
+		virtual_machine& machine();
+
+		bool done() const;
+		void wait();
+
+		// FINAL STATE ONCE DONE, SUSPENDED IF THE SCHEDULER WAS DESTROYED FIRST
+		vm::run_state result() const;
+
+		// HOST TIME SPENT RUNNING THIS GUEST'S SLICES, EXCLUDING QUEUEING
+		std::chrono::nanoseconds cpu_time() const;
+		std::uint64_t instructions() const;
+		std::uint64_t slices() const;
+
+		// WORKER THE GUEST LAST RAN ON, CHANGES ONLY WHEN IT IS STOLEN
+		size_t worker() const;
+
+	private:
+		friend class scheduler;
+
+		void complete(vm::run_state state);
+
+		virtual_machine& m_machine;
+
+		std::atomic<std::int64_t> m_cpu_time{ 0 };
+		std::atomic<std::uint64_t> m_instructions{ 0 };
+		std::atomic<std::uint64_t> m_slices{ 0 };
+		std::atomic<size_t> m_worker{ 0 };
+
+		mutable std::mutex m_done_mutex;
+		std::condition_variable m_done_condition;
+		vm::run_state m_result{ vm::run_status::suspended, 0 };
+		bool m_done = false;
+	};
+
+	// RUNS GUESTS IN INSTRUCTION-BUDGETED SLICES ON ITS OWN WORKER THREADS, EACH WITH ITS OWN DEQUE.
+	// A SUSPENDED GUEST IS REQUEUED ON THE WORKER THAT RAN IT, IDLE WORKERS STEAL FROM THE OTHERS
+	// THE WORKERS NEVER RETURN WHILE THE SCHEDULER LIVES, SO THEY ARE NOT BORROWED FROM A SHARED
+	// THREAD POOL WHERE THEY WOULD STARVE EVERY OTHER TASK
+	class scheduler
+	{
+	public:
+		static constexpr std::uint64_t default_slice = 0x2000;
+
+		explicit scheduler(size_t workers = std::thread::hardware_concurrency(), std::uint64_t slice = default_slice);
+		~scheduler();
+
+		scheduler(const scheduler&) = delete;
+		scheduler& operator=(const scheduler&) = delete;
+
+		// RESUMES AT THE GUEST'S INSTRUCTION POINTER, CALL ENTER FIRST.
+		// THE VIRTUAL MACHINE MUST OUTLIVE ITS SCHEDULED_VM
+		std::shared_ptr<vm::scheduled_vm> submit(virtual_machine& machine);
+
+		// BLOCK UNTIL EVERY SUBMITTED GUEST IS DONE
+		void wait_idle();
+
+		size_t worker_count() const;
+
+	private:
+		using job_t = std::shared_ptr<vm::scheduled_vm>;
+
+		// ALIGNED SO NEIGHBOURING WORKERS DO NOT SHARE A LOCK CACHE LINE
+		struct alignas(64) worker_queue
+		{
+			std::mutex mutex;
+			std::deque<job_t> jobs;
+		};
+
+		void worker_loop(size_t index);
+
+		void push(size_t index, job_t job);
+		job_t pop(size_t index);
+		job_t steal(size_t thief);
+
+		std::uint64_t m_slice;
+
+		std::vector<std::unique_ptr<worker_queue>> m_queues;
+		std::vector<std::thread> m_workers;
+
+		std::atomic<size_t> m_next_queue{ 0 };
+		std::atomic<size_t> m_queued{ 0 };
+		std::atomic<size_t> m_active{ 0 };
+		std::atomic<bool> m_stop{ false };
+
+		// ONLY TAKEN TO SLEEP OR WAKE, NEVER ON THE SLICE PATH
+		std::mutex m_idle_mutex;
+		std::condition_variable m_work_available;
+		std::condition_variable m_all_done;
+	};
+}
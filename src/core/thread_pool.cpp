@@ -0,0 +1,50 @@
+#include "thread_pool.hpp"
+
+namespace x64vm::core {
+
+ThreadPool::ThreadPool(size_t threads) {
+    if(threads == 0) {
+        threads = 1;
+    }
+
+    for(size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { workerThread(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+
+    for(std::thread& worker : workers_) {
+        if(worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void ThreadPool::workerThread() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+
+            if(stop_ && tasks_.empty()) {
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+
+        ++busyThreads_;
+        task();
+        --busyThreads_;
+    }
+}
+
+} // namespace x64vm::core
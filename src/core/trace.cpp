@@ -0,0 +1,159 @@
+// STD
+#include <chrono>
+
+// VM
+#include "trace.hpp"
+
+// x86
+#include "instruction_dispatch.hpp"
+#include "instruction_modrm.hpp"
+#include "instruction_rex.hpp"
+#include "register.hpp"
+
+// HELPER
+#include "global.hpp"
+
+namespace
+{
+	x86::registr::size register_size(std::uint8_t bytes)
+	{
+		switch (bytes)
+		{
+		case 2:		return x86::registr::size::word;
+		case 4:		return x86::registr::size::dword;
+		default:	return x86::registr::size::qword;
+		}
+	}
+
+	
+	std::string format_modrm_operand(const vm::trace_record& record, const x86::modrm& modrm, const x86::rex& rex, std::uint16_t variant)
+	{
+		const auto mode = x86::dispatch::variant::mode(variant);
+		const auto rm = static_cast<std::uint8_t>(modrm.rm | (rex.b << 3));
+		if (mode == 3)
+			return x86::registr::names[rm][register_size(x86::dispatch::variant::operand_size(variant))];
+
+		const auto address_size = register_size(x86::dispatch::variant::address_size(variant));
+
+		std::string address{};
+		if (modrm.rip_relative())
+		{
+			address = "RIP";
+		}
+		else if (modrm.has_sib())
+		{
+			auto sib = x86::sib{};
+			*reinterpret_cast<std::uint8_t*>(&sib) = record.sib;
+
+			if (sib.has_base(mode))
+				address = x86::registr::names[sib.base | (rex.b << 3)][address_size];
+
+			const auto index = static_cast<std::uint8_t>(sib.index | (rex.x << 3));
+			if (index != 4)
+				address += fmt::format("{}{}*{}", address.empty() ? "" : "+", x86::registr::names[index][address_size], 1 << sib.scale);
+		}
+		else
+		{
+			address = x86::registr::names[rm][address_size];
+		}
+
+		if (record.displacement != 0 || address.empty())
+		{
+			const auto negative = record.displacement < 0;
+			const auto magnitude = negative ? -static_cast<std::int64_t>(record.displacement) : record.displacement;
+			address += fmt::format("{}{:X}", negative ? "-" : address.empty() ? "" : "+", magnitude);
+		}
+
+		return fmt::format("[{}]", address);
+	}
+}
+
+std::string vm::format_trace_record(const vm::trace_record& record)
+{
+	auto modrm = x86::modrm{};
+	auto rex = x86::rex{};
+	*reinterpret_cast<std::uint8_t*>(&modrm) = record.modrm;
+	*reinterpret_cast<std::uint8_t*>(&rex) = record.rex;
+
+	const std::uint8_t reg = modrm.reg | (rex.r << 3);
+
+	
+	const auto in_family = [&record](std::uint16_t base)
+	{
+		return record.handler >= base && record.handler < base + x86::dispatch::variant::count;
+	};
+
+	if (in_family(x86::dispatch::add_displaced_source))
+	{
+		const auto variant = static_cast<std::uint16_t>(record.handler - x86::dispatch::add_displaced_source);
+		const auto& destination = x86::registr::names[reg][register_size(x86::dispatch::variant::operand_size(variant))];
+
+		return fmt::format("[T] {:X}  ADD {}, {}", record.address, destination, format_modrm_operand(record, modrm, rex, variant));
+	}
+
+	if (in_family(x86::dispatch::add_displaced_destination))
+	{
+		const auto variant = static_cast<std::uint16_t>(record.handler - x86::dispatch::add_displaced_destination);
+
+		return fmt::format("[T] {:X}  ADD {}, {:X}", record.address, format_modrm_operand(record, modrm, rex, variant), static_cast<std::int32_t>(record.immediate));
+	}
+
+	
+	std::string opcode{};
+	for (size_t i = 0; i < record.opcode_size; i++)
+		opcode += fmt::format("{:02X}", record.opcode[i]);
+
+	return fmt::format("[T] {:X}  ??? [{}] ({} bytes)", record.address, opcode, record.size);
+}
+
+vm::trace_buffer<true>::trace_buffer() : m_records()
+{
+	this->m_formatter = std::thread([this]() { this->drain(); });
+}
+
+vm::trace_buffer<true>::~trace_buffer()
+{
+	this->m_stop.store(true, std::memory_order_release);
+
+	if (this->m_formatter.joinable())
+		this->m_formatter.join();
+}
+
+void vm::trace_buffer<true>::flush()
+{
+	while (this->m_tail.load(std::memory_order_acquire) != this->m_head.load(std::memory_order_acquire))
+		std::this_thread::yield();
+}
+
+void vm::trace_buffer<true>::drain()
+{
+	while (true)
+	{
+		const auto head = this->m_head.load(std::memory_order_acquire);
+		auto tail = this->m_tail.load(std::memory_order_relaxed);
+
+		if (head == tail)
+		{
+			
+			if (this->m_stop.load(std::memory_order_acquire))
+				break;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		
+		for (; tail != head; tail++)
+		{
+			const auto line = vm::format_trace_record(this->m_records[tail & (capacity - 1)]);
+			global::console.log_raw("{}\n", line);
+		}
+
+		this->m_tail.store(tail, std::memory_order_release);
+
+		
+		const auto dropped = this->m_dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped != 0)
+			global::console.log_raw("[!] {} trace records dropped\n", dropped);
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// STD
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// x86
+#include "instruction.hpp"
+
+namespace vm
+{
+#if defined(X64VM_TRACE)
+	constexpr bool trace_enabled = true;
+#else
+	constexpr bool trace_enabled = false;
+#endif
+
+	// COMPACT BINARY RECORD OF ONE EXECUTED INSTRUCTION, FORMATTED LATER
+	struct trace_record
+	{
+		std::uint64_t address;
+		std::uint64_t immediate;
+		std::int32_t displacement;
+		std::uint16_t handler;
+		std::array<std::uint8_t, 3> opcode;
+		std::uint8_t opcode_size;
+		std::uint8_t modrm;
+		std::uint8_t rex;
+		std::uint8_t size;
+		std::uint8_t sib;
+	};
+	static_assert(sizeof(vm::trace_record) == 32, "trace records should stay half a cache line");
+
+
+	inline vm::trace_record make_trace_record(std::uint8_t* address, x86::instruction& instr)
+	{
+		vm::trace_record record{};
+		record.address = reinterpret_cast<std::uint64_t>(address);
+		record.immediate = instr.immediate();
+		record.displacement = instr.displacement();
+		record.handler = instr.handler();
+		record.size = instr.size();
+
+		record.opcode_size = static_cast<std::uint8_t>(instr.opcode().buffer().size());
+		for (size_t i = 0; i < record.opcode_size; i++)
+			record.opcode[i] = instr.opcode().buffer().at(i);
+
+		if (instr.modrm().has_value())
+			record.modrm = *reinterpret_cast<std::uint8_t*>(&instr.modrm().value());
+
+		if (instr.sib().has_value())
+			record.sib = *reinterpret_cast<std::uint8_t*>(&instr.sib().value());
+
+		if (instr.rex().has_value())
+			record.rex = *reinterpret_cast<std::uint8_t*>(&instr.rex().value());
+
+		return record;
+	}
+
+	
+	std::string format_trace_record(const vm::trace_record& record);
+
+	// TRACING DISABLED: EVERY CALL COMPILES TO NOTHING
+	template <bool Enabled>
+	class trace_buffer
+	{
+	public:
+		void record(std::uint8_t* address [[maybe_unused]], x86::instruction& instr [[maybe_unused]]) {}
+		void flush() {}
+	};
+
+	// TRACING ENABLED: SINGLE-PRODUCER RING, DRAINED AND FORMATTED BY A BACKGROUND THREAD
+	template <>
+	class trace_buffer<true>
+	{
+	public:
+		static constexpr size_t capacity = 0x1000;
+		static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+		trace_buffer();
+		~trace_buffer();
+
+		trace_buffer(const trace_buffer&) = delete;
+		trace_buffer& operator=(const trace_buffer&) = delete;
+
+
+		void record(std::uint8_t* address, x86::instruction& instr)
+		{
+			const auto head = this->m_head.load(std::memory_order_relaxed);
+
+			// NEVER STALL THE GUEST ON A SLOW CONSOLE, DROP AND COUNT INSTEAD
+			if (head - this->m_tail.load(std::memory_order_acquire) == capacity)
+			{
+				this->m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			this->m_records[head & (capacity - 1)] = vm::make_trace_record(address, instr);
+			this->m_head.store(head + 1, std::memory_order_release);
+		}
+
+		// BLOCK UNTIL EVERY RECORDED INSTRUCTION HAS BEEN FORMATTED
+		void flush();
+
+	private:
+		void drain();
+
+		std::array<vm::trace_record, capacity> m_records;
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+		std::atomic<size_t> m_dropped{ 0 };
+		std::atomic<bool> m_stop{ false };
+		std::thread m_formatter;
+	};
+}
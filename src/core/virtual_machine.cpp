@@ -1,12 +1,34 @@
+// STD
+#include <algorithm>
+
 // VM
 #include "virtual_machine.hpp"
 #include "handlers.hpp"
 
 // x86
 #include "instruction_modrm.hpp"
+#include "instruction_dispatch.hpp"
 #include "register.hpp"
 
-std::vector<std::uint8_t>& virtual_machine::buffer()
+// HELPER
+#include "global.hpp"
+
+virtual_machine::virtual_machine(virtual_machine& parent, clone_tag) :
+	m_buffer(parent.m_buffer),
+	m_context(parent.m_context),
+	m_stack(parent.m_stack),
+	m_fault_handler(parent.m_fault_handler)
+{
+	this->memory().clone_from(parent.memory());
+	this->watch_code_writes();
+}
+
+std::unique_ptr<virtual_machine> virtual_machine::clone()
+{
+	return std::unique_ptr<virtual_machine>(new virtual_machine(*this, clone_tag{}));
+}
+
+vm::code_view virtual_machine::buffer()
 {
 	return this->m_buffer;
 }
@@ -20,26 +42,284 @@ vm::virtual_memory& virtual_machine::memory()
 	return this->m_memory;
 }
 
-void virtual_machine::handle_instruction(x86::instruction& instr)
+vm::block_cache& virtual_machine::blocks()
 {
-	auto vm_instance = const_cast<virtual_machine*>(this);
+	return this->m_blocks;
+}
 
-	
-	switch (instr.opcode().as<uint32_t>())
+vm::trace_buffer<vm::trace_enabled>& virtual_machine::trace()
+{
+	return this->m_trace;
+}
+
+void virtual_machine::set_fault_handler(fault_handler_t handler)
+{
+	this->m_fault_handler = std::move(handler);
+}
+
+vm::fault& virtual_machine::last_fault()
+{
+	return this->m_last_fault;
+}
+
+vm::run_state virtual_machine::run_for(std::uint64_t max_instructions)
+{
+	auto& instruction_pointer = this->context().instruction_pointer();
+
+	// CODE IS ONLY EVER READ, THE POINTER TYPE MATCHES THE INSTRUCTION POINTER
+	const auto buffer_end = const_cast<std::uint8_t*>(this->buffer().data()) + this->buffer().size();
+
+	auto budget = max_instructions;
+	vm::run_state state{ vm::run_status::finished, 0 };
+
+	this->last_fault() = vm::fault{};
+
+	auto& block = this->m_last_block;
+	while (instruction_pointer != buffer_end)
 	{
-	
-	case x86::opcode::add_byte:			
-	case x86::opcode::add_displaced_byte:
-	case x86::opcode::add_displaced_source:
-	case x86::opcode::add_al:
-	case x86::opcode::add_rax:
-	case x86::opcode::add_wide:
-	case x86::opcode::add_displaced_destination:
-	case x86::opcode::add_byte_extended:
-		vm::handler::add::handle(vm_instance, instr);
+		// NO INSTRUCTION OF A DROPPED BLOCK IS RUNNING ANYMORE, AND THE PREVIOUS BLOCK MAY BE ONE
+		if (this->m_code_modified)
+		{
+			this->m_code_modified = false;
+			this->blocks().release_retired();
+			block = nullptr;
+		}
+
+		if (budget == 0)
+		{
+			state.status = vm::run_status::suspended;
+			return state;
+		}
+
+		// BRANCHES CHECK THEIR TARGETS, THIS CATCHES ENTER() AND FAULT HANDLERS POINTING ELSEWHERE
+		// NOTHING OUTSIDE THE CODE IS EVER DECODED
+		if (!this->valid_target(instruction_pointer))
+		{
+			block = nullptr;
+			this->last_fault() = vm::fault{ vm::fault_code::invalid_target, instruction_pointer, instruction_pointer };
+			state.status = vm::run_status::faulted;
+			return state;
+		}
+
+		block = &this->next_block(block, buffer_end);
+
+		// CHARGE THE WHOLE BLOCK UP FRONT, ONE DECREMENT PER BLOCK INSTEAD OF PER INSTRUCTION
+		const auto cost = static_cast<std::uint64_t>(block->instructions.size());
+		budget -= std::min(budget, cost);
+		state.instructions += cost;
+
+		if (!this->execute_block(*block))
+		{
+			// THE BLOCK DID NOT REACH ITS EXIT, SO ITS EXIT KIND SAYS NOTHING ABOUT WHAT COMES NEXT
+			block = nullptr;
+			state.status = vm::run_status::faulted;
+			return state;
+		}
+	}
+
+	return state;
+}
+
+bool virtual_machine::valid_target(std::uint8_t* address)
+{
+	const auto code = const_cast<std::uint8_t*>(this->buffer().data());
+	return address >= code && address <= code + this->buffer().size();
+}
+
+void virtual_machine::predict_return(std::uint8_t* return_address)
+{
+	// THE PUSH MAY HAVE OVERWRITTEN CACHED CODE, THE RUNNING BLOCK IS THEN ALREADY DROPPED
+	if (this->m_code_modified)
 		return;
+
+	// THE RUNNING BLOCK ENDS IN THIS CALL, UNLESS THE INSTRUCTION WAS EXECUTED OUTSIDE THE RUN LOOP
+	const auto caller = this->m_last_block;
+	if (caller != nullptr && caller->exit == vm::block_exit::call && caller->end == return_address)
+		this->m_return_stack.push(*caller, this->blocks().epoch());
+}
+
+vm::basic_block& virtual_machine::next_block(vm::basic_block* previous, std::uint8_t* buffer_end)
+{
+	const auto instruction_pointer = this->context().instruction_pointer();
+
+	// CHAINED: NO LOOKUP WHILE EXECUTION STAYS ON LINKED EDGES
+	vm::basic_block** exit = nullptr;
+	// A CORRECT PREDICTION CONTINUES AT THE CALLER'S FALLTHROUGH LINK
+	if (previous != nullptr && previous->exit == vm::block_exit::ret)
+		previous = this->m_return_stack.pop(instruction_pointer, this->blocks().epoch());
+
+	if (previous != nullptr)
+	{
+		exit = instruction_pointer == previous->end ? &previous->fallthrough : &previous->taken;
+		if (*exit != nullptr && (*exit)->start == instruction_pointer)
+			return **exit;
+	}
+
 	
-	default:
-		vm::handler::unknown(instr);
+	auto block = this->blocks().find(instruction_pointer);
+	if (block == nullptr)
+	{
+		block = &this->blocks().build(instruction_pointer, buffer_end, this->memory());
+		this->mark_code(*block);
+	}
+
+	if (exit != nullptr && (exit == &previous->fallthrough || previous->exit != vm::block_exit::ret))
+		this->blocks().link(*previous, *exit, *block);
+
+	return *block;
+}
+
+vm::run_state virtual_machine::run_until(std::chrono::steady_clock::time_point deadline)
+{
+	vm::run_state state{ vm::run_status::suspended, 0 };
+
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+		const auto slice = this->run_for(virtual_machine::deadline_slice);
+		state.instructions += slice.instructions;
+		state.status = slice.status;
+
+		if (!slice.resumable())
+			break;
 	}
-}
\ No newline at end of file
+
+	return state;
+}
+
+bool virtual_machine::execute_block(vm::basic_block& block)
+{
+	auto& instruction_pointer = this->context().instruction_pointer();
+
+#if defined(X64VM_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+	// THREADED CODE: EVERY HANDLER SITE OWNS ITS INDIRECT JUMP TO THE NEXT ONE
+	static void* const labels[] =
+	{
+#define X64VM_HANDLER_LABEL(name) &&handler_##name,
+		X64VM_HANDLER_IDS(X64VM_HANDLER_LABEL)
+#undef X64VM_HANDLER_LABEL
+	};
+	static_assert(sizeof(labels) / sizeof(labels[0]) == x86::dispatch::END_OF_HANDLER);
+
+	auto instr = block.instructions.data();
+	const auto last = instr + block.instructions.size();
+	auto next_instruction = instruction_pointer;
+
+#define X64VM_DISPATCH()									\
+	if (instr == last)										\
+		return true;										\
+	this->m_trace.record(instruction_pointer, *instr);		\
+	instruction_pointer += instr->size();					\
+	next_instruction = instruction_pointer;					\
+	goto *labels[instr->handler()]
+
+	X64VM_DISPATCH();
+
+#define X64VM_HANDLER_BODY(name)							\
+handler_##name:												\
+	if (!this->dispatch<x86::dispatch::name>(*instr))		\
+		return false;										\
+	if (instruction_pointer != next_instruction ||			\
+		this->m_code_modified)								\
+		return true;										\
+	++instr;												\
+	X64VM_DISPATCH();
+
+	X64VM_HANDLER_IDS(X64VM_HANDLER_BODY)
+
+#undef X64VM_HANDLER_BODY
+#undef X64VM_DISPATCH
+#else
+	for (auto& instr : block.instructions)
+	{
+		this->m_trace.record(instruction_pointer, instr);
+
+		
+		instruction_pointer += instr.size();
+		const auto next_instruction = instruction_pointer;
+
+		
+		const auto fault = this->handle_instruction(instr);
+		if (fault && !this->deliver_fault(fault, instr))
+			return false;
+
+		
+		if (instruction_pointer != next_instruction || this->m_code_modified)
+			return true;
+	}
+
+	return true;
+#endif
+}
+
+void virtual_machine::watch_code_writes()
+{
+	this->memory().set_code_write_handler([this](std::uint8_t* page, std::uint32_t)
+	{
+		if (this->blocks().invalidate_page(page) != 0)
+			this->m_code_modified = true;
+	});
+}
+
+void virtual_machine::mark_code(vm::basic_block& block)
+{
+	// ONLY PAGES MAPPED IN GUEST MEMORY CAN BE WRITTEN BY THE GUEST, AND THOSE ARE THE PAGES
+	// THE BLOCK WAS DECODED FROM
+	for (auto page = block.start; page < block.end; page += vm::virtual_memory::page_size)
+		this->memory().mark_code(page);
+
+	if (block.end != block.start)
+		this->memory().mark_code(block.end - 1);
+}
+
+vm::fault virtual_machine::handle_instruction(x86::instruction& instr)
+{
+	return vm::handler::table[instr.handler()](this, instr);
+}
+
+template <std::uint16_t Handler>
+bool virtual_machine::dispatch(x86::instruction& instr)
+{
+	const auto fault = vm::handler::table[Handler](this, instr);
+	return !fault || this->deliver_fault(fault, instr);
+}
+
+bool virtual_machine::deliver_fault(vm::fault fault, x86::instruction& instr)
+{
+	auto& instruction_pointer = this->context().instruction_pointer();
+	const auto next_instruction = instruction_pointer;
+
+	do
+	{
+		fault.instruction = next_instruction - instr.size();
+
+		
+		auto action = vm::fault_action::skip;
+		if (this->m_fault_handler)
+		{
+			action = this->m_fault_handler(*this, fault);
+		}
+		else
+		{
+			global::console.log_error_indented<1>(vm::to_string(fault.code));
+		}
+
+		switch (action)
+		{
+		case vm::fault_action::retry:
+			instruction_pointer = next_instruction;
+			fault = this->handle_instruction(instr);
+			break;
+
+		case vm::fault_action::skip:
+			return true;
+
+		case vm::fault_action::stop:
+			
+			instruction_pointer = fault.instruction;
+			this->last_fault() = fault;
+			return false;
+		}
+	} while (fault);
+
+	return true;
+}
@@ -2,13 +2,24 @@
 
 // STD
 #include <array>
-#include <vector>
+#include <chrono>
+#include <limits>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <type_traits>
 
 // x86
 #include "disasm.hpp"
 #include "register.hpp"
 
 // VM
+#include "block_cache.hpp"
+#include "fault.hpp"
+#include "mapped_image.hpp"
+#include "return_stack.hpp"
+#include "run_state.hpp"
+#include "trace.hpp"
 #include "virtual_stack.hpp"
 #include "virtual_memory.hpp"
 
@@ -20,51 +31,105 @@ constexpr std::uint32_t vm_stack_size = 0x1000;
 class virtual_machine
 {
 public:
+	// THE CODE IS NOT COPIED, THE CALLER KEEPS IT ALIVE FOR THE LIFETIME OF THE VIRTUAL MACHINE
+	// GUEST MEMORY MAPPED OVER PART OF THE CODE REPLACES THOSE BYTES, WHICH IS HOW A GUEST MODIFIES ITS OWN CODE
 	template <class T, size_t N>
-	virtual_machine(T(&buffer)[N]) : m_buffer(buffer, buffer + N), m_stack(vm_alignment, vm_stack_size) {}
-	virtual_machine(std::vector<std::uint8_t> buffer) : m_buffer(buffer), m_stack(vm_alignment, vm_stack_size) {}
+	virtual_machine(T(&buffer)[N]) : m_buffer(buffer, N), m_stack(vm_alignment, vm_stack_size) { this->watch_code_writes(); }
+	virtual_machine(vm::code_view buffer) : m_buffer(buffer), m_stack(vm_alignment, vm_stack_size) { this->watch_code_writes(); }
+	virtual_machine(const vm::mapped_image& image) : virtual_machine(image.view()) {}
+
+	// THE VIEW WOULD DANGLE AS SOON AS THE CONSTRUCTOR RETURNS. SPAN<CONST T> HAPPILY BINDS
+	// RVALUE CONTAINERS, SO OWNING TEMPORARIES HAVE TO BE REJECTED EXPLICITLY
+	virtual_machine(vm::mapped_image&&) = delete;
+
+	template <class Container>
+		requires (!std::is_lvalue_reference_v<Container> && std::ranges::contiguous_range<Container> && !std::ranges::borrowed_range<Container>)
+	virtual_machine(Container&&) = delete;
+
+	virtual_machine(const virtual_machine&) = delete;
+	virtual_machine& operator=(const virtual_machine&) = delete;
+
+	// COPY-ON-WRITE CHILD: GUEST PAGES STAY SHARED UNTIL EITHER SIDE WRITES ONE, REGISTERS, STACK
+	// AND THE FAULT HANDLER ARE COPIED. THE PARENT MUST NOT BE RUNNING WHILE IT IS CLONED
+	std::unique_ptr<virtual_machine> clone();
 
 	
-	std::vector<std::uint8_t>& buffer();	
+	vm::code_view buffer();					
 	x86::registr& context();				
 	vm::virtual_memory& memory();			
+	vm::block_cache& blocks();				
+	vm::trace_buffer<vm::trace_enabled>& trace();
+
+	// EMBEDDER CALLBACK FOR GUEST FAULTS, MAY REDIRECT THE INSTRUCTION POINTER TO A GUEST HANDLER
+	using fault_handler_t = std::function<vm::fault_action(virtual_machine& vm, const vm::fault& fault)>;
+	void set_fault_handler(fault_handler_t handler);
+
+	// FAULT THAT STOPPED THE LAST RUN, CODE IS NONE OTHERWISE
+	vm::fault& last_fault();
 
 	
-	void handle_instruction(x86::instruction& instr);
+	vm::fault handle_instruction(x86::instruction& instr);
+
+	// RETURNS FALSE WHEN A FAULT STOPPED EXECUTION
+	bool execute_block(vm::basic_block& block);
+
+	// CONTROL MAY ONLY MOVE TO AN INSTRUCTION INSIDE THE CODE, OR TO ITS END, WHICH FINISHES THE RUN
+	bool valid_target(std::uint8_t* address);
+
+	// CALLED BY CALL ONCE IT HAS PUSHED THE RETURN ADDRESS AND TRANSFERRED CONTROL, SO A CALL THAT
+	// FAULTED AND WAS SKIPPED NEVER LEAVES THE SHADOW RETURN STACK OUT OF STEP WITH THE GUEST'S
+	void predict_return(std::uint8_t* return_address);
+
+	// POINT THE VIRTUAL MACHINE AT AN OFFSET INTO ITS CODE WITHOUT RUNNING ANYTHING
+	template <class T>
+	void enter(T offset)
+	{
+		// CODE IS ONLY EVER READ, THE POINTER TYPE MATCHES THE INSTRUCTION POINTER
+		this->context().instruction_pointer() = const_cast<std::uint8_t*>(this->buffer().data()) + offset;
+		this->last_fault() = vm::fault{};
+
+		// A FRESH ENTRY HAS NO PREDECESSOR TO CHAIN FROM AND NO CALLS TO RETURN TO
+		this->m_last_block = nullptr;
+		this->m_return_stack.clear();
+	}
 
 	
 	template <class T>
-	void run(T offset)
+	vm::run_state run(T offset)
 	{
-		
-		auto disassembler = x86::disassembler(this->buffer());
-
-		
-		disassembler.iterate(offset, [this](x86::instruction instr, std::uint8_t*& instruction_pointer)
-		{
-			
-			this->context().instruction_pointer() = instruction_pointer;
-
-			try
-			{
-				
-				this->handle_instruction(instr);
-			}
-			catch (std::exception exception)
-			{
-				
-				global::console.log_error_indented<1>(exception.what());
-			}
-		
-
-			
-			instruction_pointer = this->context().instruction_pointer();
-		});
+		this->enter(offset);
+		return this->run_for(std::numeric_limits<std::uint64_t>::max());
 	}
 
+	// RESUME AT THE INSTRUCTION POINTER, THE BUDGET IS CHECKED BETWEEN BLOCKS SO A SLICE
+	// MAY OVERSHOOT BY AT MOST ONE BLOCK
+	vm::run_state run_for(std::uint64_t max_instructions);
+
+	// RESUME AT THE INSTRUCTION POINTER, THE CLOCK IS ONLY READ EVERY DEADLINE_SLICE INSTRUCTIONS
+	static constexpr std::uint64_t deadline_slice = 0x4000;
+	vm::run_state run_until(std::chrono::steady_clock::time_point deadline);
+
 private:
+	struct clone_tag {};
+	virtual_machine(virtual_machine& parent, clone_tag);
+
+	
+	template <std::uint16_t Handler>
+	bool dispatch(x86::instruction& instr);
+
+	// COLD PATH, RETURNS FALSE WHEN EXECUTION SHOULD STOP
+	bool deliver_fault(vm::fault fault, x86::instruction& instr);
+
+	// FOLLOW THE PREVIOUS BLOCK'S LINK (OR THE PREDICTED CALLER'S, AFTER A RET) TO THE
+	// INSTRUCTION POINTER, FALLING BACK TO THE CACHE
+	vm::basic_block& next_block(vm::basic_block* previous, std::uint8_t* buffer_end);
+
+	// SELF-MODIFYING CODE: WRITES TO PAGES BACKING CACHED BLOCKS DROP THOSE BLOCKS
+	void watch_code_writes();
+	void mark_code(vm::basic_block& block);
+
 	
-	std::vector<std::uint8_t> m_buffer;
+	vm::code_view m_buffer;
 
 	
 	x86::registr m_context;
@@ -74,4 +139,21 @@ private:
 
 	
 	vm::virtual_memory m_memory;
+
+	
+	vm::block_cache m_blocks;
+
+	
+	fault_handler_t m_fault_handler;
+	vm::fault m_last_fault{};
+
+	// SET WHEN THE RUNNING BLOCK MAY BE STALE, ENDS IT AFTER THE CURRENT INSTRUCTION
+	bool m_code_modified = false;
+
+	// KEPT ACROSS RUN SLICES SO CHAINING AND RETURN PREDICTION SURVIVE A SUSPEND
+	vm::basic_block* m_last_block = nullptr;
+	vm::return_stack m_return_stack;
+
+	// EMPTY UNLESS BUILT WITH X64VM_TRACE
+	vm::trace_buffer<vm::trace_enabled> m_trace;
 };
\ No newline at end of file
@@ -1,86 +1,324 @@
+// STD
+#include <cstring>
+
+// VM
 #include "virtual_memory.hpp"
 
+vm::virtual_memory::~virtual_memory()
+{
+	for (const auto& [page_start, page_count] : this->m_allocations)
+	{
+		for (size_t page_index = 0; page_index < page_count; page_index++)
+			this->release_frame(*this->find_page(page_start + vm::virtual_memory::page_size * page_index));
+	}
+}
+
+void vm::virtual_memory::clone_from(vm::virtual_memory& parent)
+{
+	this->m_frames = parent.m_frames;
+	this->m_allocations = parent.m_allocations;
+
+	this->page_table().copy_from(parent.page_table(), [this](vm::page_table::entry_t& entry)
+	{
+		// UNTOUCHED PAGES STAY ON THE ZERO FRAME ON BOTH SIDES
+		if ((entry & vm::page_table::demand_zero) == 0)
+		{
+			if (entry & vm::page_table::writable)
+				entry = (entry & ~static_cast<vm::page_table::entry_t>(vm::page_table::writable)) | vm::page_table::copy_on_write;
+
+			this->frames().share(vm::page_table::frame(entry));
+		}
+
+		// NOTHING IS DECODED IN THE CLONE YET
+		return entry & ~static_cast<vm::page_table::entry_t>(vm::page_table::code);
+	});
+
+	// THE PARENT'S CACHED TRANSLATIONS ARE STILL WRITABLE
+	parent.flush_tlb();
+	this->flush_tlb();
+}
+
 bool vm::virtual_memory::allocate(std::uint8_t* address, size_t size)
 {
-	
-	auto page_start = vm::virtual_memory::round_to_page(address);
+	const auto page_start = vm::virtual_memory::round_to_page(address);
+	const auto page_end = vm::virtual_memory::round_to_page(address + std::max<size_t>(size, 1) + vm::virtual_memory::page_size - 1);
+	const auto page_count = static_cast<size_t>(page_end - page_start) / vm::virtual_memory::page_size;
 
-	
-	const auto search = this->address_space().find(page_start);
-	if (search != this->address_space().end())
+	for (size_t page_index = 0; page_index < page_count; page_index++)
 	{
+		const auto page = page_start + vm::virtual_memory::page_size * page_index;
+		if (!vm::page_table::canonical(page) || this->find_page(page) != nullptr)
+			return false;
+	}
+
+	// NOTHING IS ALLOCATED OR ZEROED UNTIL A PAGE IS FIRST WRITTEN
+	const auto zero_entry = reinterpret_cast<vm::page_table::entry_t>(this->frames().zero_frame()) |
+		vm::page_table::present | vm::page_table::copy_on_write | vm::page_table::demand_zero;
+
+	for (size_t page_index = 0; page_index < page_count; page_index++)
+		*this->page_table().emplace(page_start + vm::virtual_memory::page_size * page_index) = zero_entry;
+
+	this->m_allocations.emplace(page_start, page_count);
+	this->flush_tlb();
+
+	return true;
+}
+
+bool vm::virtual_memory::free(std::uint8_t* address)
+{
+	const auto page_start = vm::virtual_memory::round_to_page(address);
+
+	const auto search = this->m_allocations.find(page_start);
+	if (search == this->m_allocations.end())
 		return false;
+
+	for (size_t page_index = 0; page_index < search->second; page_index++)
+	{
+		const auto page = page_start + vm::virtual_memory::page_size * page_index;
+
+		auto entry = this->find_page(page);
+
+		// UNMAPPING CHANGES THE CODE AS MUCH AS OVERWRITING IT, BLOCKS DECODED FROM THE PAGE MUST GO
+		if (*entry & vm::page_table::code)
+			this->code_written(page, *entry);
+
+		this->release_frame(*entry);
+		*entry = 0;
+
+		this->m_generations.erase(page);
 	}
 
-	auto section = std::make_shared<vm::virtual_section>(page_start);
+	this->m_allocations.erase(search);
+	this->flush_tlb();
+
+	return true;
+}
+
+bool vm::virtual_memory::mark_code(std::uint8_t* address)
+{
+	const auto page_start = vm::virtual_memory::round_to_page(address);
+
+	const auto entry = this->find_page(page_start);
+	if (entry == nullptr)
+		return false;
+
+	*entry |= vm::page_table::code;
+
+	// A CACHED WRITABLE TRANSLATION WOULD SKIP THE CODE CHECK
+	this->flush_tlb(page_start);
+	return true;
+}
+
+std::uint32_t vm::virtual_memory::generation(std::uint8_t* address)
+{
+	const auto search = this->m_generations.find(vm::virtual_memory::round_to_page(address));
+	if (search == this->m_generations.end())
+		return 0;
+
+	return search->second;
+}
+
+void vm::virtual_memory::set_code_write_handler(code_write_handler_t handler)
+{
+	this->m_code_write_handler = std::move(handler);
+}
+
+void vm::virtual_memory::flush_tlb()
+{
+	this->m_tlb.fill(tlb_entry{});
+}
+
+void vm::virtual_memory::flush_tlb(std::uint8_t* address)
+{
+	const auto page_start = vm::virtual_memory::round_to_page(address);
+
+	auto& entry = this->tlb_slot(page_start);
+	if (entry.page == page_start)
+		entry = tlb_entry{};
+}
+
+void vm::virtual_memory::tlb_fill(std::uint8_t* page_start, vm::page_table::entry_t entry)
+{
+	const bool writable = (entry & vm::page_table::writable) != 0 && (entry & vm::page_table::code) == 0;
 
-	const auto next_page = page_start + vm::virtual_memory::page_size;
-	const auto exceeds_page = (address + size) >= next_page;
+	auto& slot = this->tlb_slot(page_start);
+	slot.page = page_start;
+	slot.host = vm::page_table::frame(entry);
+	slot.permissions = writable ? tlb_read | tlb_write : tlb_read;
+}
 
-	if (!exceeds_page)
+vm::fault vm::virtual_memory::check_mapped(std::uint8_t* address, size_t size)
+{
+	for (auto page_start = vm::virtual_memory::round_to_page(address); page_start < address + size; page_start += vm::virtual_memory::page_size)
 	{
-	
-		section.get()->add<vm::virtual_memory::page_size>();
-		this->address_space().emplace(page_start, section);
+		if (this->find_page(page_start) == nullptr)
+			return vm::fault{ vm::fault_code::page_fault, std::max(page_start, address), nullptr };
 	}
-	else
+
+	return vm::fault{};
+}
+
+vm::fault vm::virtual_memory::read_block(std::uint8_t* address, void* destination, size_t size)
+{
+	const auto buffer = static_cast<std::uint8_t*>(destination);
+
+	return this->walk<false>(address, size, [buffer](std::uint8_t* host, size_t offset, size_t length)
+	{
+		std::memcpy(buffer + offset, host, length);
+	});
+}
+
+vm::fault vm::virtual_memory::write_block(std::uint8_t* address, const void* source, size_t size)
+{
+	const auto buffer = static_cast<const std::uint8_t*>(source);
+
+	return this->walk<true>(address, size, [buffer](std::uint8_t* host, size_t offset, size_t length)
+	{
+		std::memcpy(host, buffer + offset, length);
+	});
+}
+
+vm::fault vm::virtual_memory::fill(std::uint8_t* address, std::uint8_t value, size_t size)
+{
+	return this->walk<true>(address, size, [value](std::uint8_t* host, size_t, size_t length)
 	{
-		auto bytes_left = size;
-		auto page_index = 0;
-		auto page_address = address;
-		do
+		std::memset(host, value, length);
+	});
+}
+
+vm::fault vm::virtual_memory::copy_within(std::uint8_t* destination, std::uint8_t* source, size_t size)
+{
+	if (const auto fault = this->check_mapped(source, size))
+		return fault;
+
+	if (const auto fault = this->check_mapped(destination, size))
+		return fault;
+
+	// GUEST PAGES ARE NOT HOST CONTIGUOUS, SO OVERLAP IS RESOLVED BY CHUNK ORDER LIKE MEMMOVE
+	const bool backwards = destination > source && destination < source + size;
+
+	size_t done = 0;
+	while (done < size)
+	{
+		const auto remaining = size - done;
+
+		// A CHUNK NEVER CROSSES A PAGE ON EITHER SIDE
+		size_t offset;
+		size_t length;
+		if (backwards)
 		{
-			
-			const auto page_offset = vm::virtual_memory::get_page_offset(page_address);
+			const auto source_last = source + remaining - 1;
+			const auto destination_last = destination + remaining - 1;
+			length = std::min({ remaining,
+				vm::virtual_memory::get_page_offset(source_last) + 1,
+				vm::virtual_memory::get_page_offset(destination_last) + 1 });
+			offset = remaining - length;
+		}
+		else
+		{
+			offset = done;
+			length = std::min({ remaining,
+				vm::virtual_memory::page_size - vm::virtual_memory::get_page_offset(source + offset),
+				vm::virtual_memory::page_size - vm::virtual_memory::get_page_offset(destination + offset) });
+		}
+
+		const auto from = vm::page_table::frame(*this->find_page(source + offset)) + vm::virtual_memory::get_page_offset(source + offset);
+		const auto to_page = vm::virtual_memory::round_to_page(destination + offset);
+		auto& to_entry = *this->writable_page(to_page);
 
-			
-			const auto count_to_end = vm::virtual_memory::page_size - page_offset;
-			auto bytes_allocated =  std::min(page_offset == 0 ? vm::virtual_memory::page_size : count_to_end, bytes_left);
+		std::memmove(vm::page_table::frame(to_entry) + vm::virtual_memory::get_page_offset(destination + offset), from, length);
 
-			
-			page_address = page_start + vm::virtual_memory::page_size * page_index;
+		if (to_entry & vm::page_table::code)
+			this->code_written(to_page, to_entry);
 
-			
-			section.get()->add<vm::virtual_memory::page_size>();
-			this->address_space().emplace(page_address, section);
+		done += length;
+	}
+
+	return vm::fault{};
+}
+
+vm::fault vm::virtual_memory::compare(std::uint8_t* address, const void* data, size_t size, int& result)
+{
+	const auto buffer = static_cast<const std::uint8_t*>(data);
 
-			
-			++page_index;
+	// THE WALK CANNOT STOP EARLY, LATER RUNS ARE SKIPPED ONCE A DIFFERENCE IS FOUND
+	result = 0;
+	return this->walk<false>(address, size, [buffer, &result](std::uint8_t* host, size_t offset, size_t length)
+	{
+		if (result == 0)
+			result = std::memcmp(host, buffer + offset, length);
+	});
+}
 
-			bytes_left -= bytes_allocated;
+vm::fault vm::virtual_memory::compare_within(std::uint8_t* first, std::uint8_t* second, size_t size, int& result)
+{
+	if (const auto fault = this->check_mapped(first, size))
+		return fault;
 
-		} while (bytes_left > 0);
+	if (const auto fault = this->check_mapped(second, size))
+		return fault;
+
+	result = 0;
+	for (size_t offset = 0; offset < size && result == 0;)
+	{
+		const auto length = std::min({ size - offset,
+			vm::virtual_memory::page_size - vm::virtual_memory::get_page_offset(first + offset),
+			vm::virtual_memory::page_size - vm::virtual_memory::get_page_offset(second + offset) });
+
+		const auto left = vm::page_table::frame(*this->find_page(first + offset)) + vm::virtual_memory::get_page_offset(first + offset);
+		const auto right = vm::page_table::frame(*this->find_page(second + offset)) + vm::virtual_memory::get_page_offset(second + offset);
+
+		result = std::memcmp(left, right, length);
+		offset += length;
 	}
 
-	return true;
+	return vm::fault{};
 }
 
-bool vm::virtual_memory::free(std::uint8_t* address)
+void vm::virtual_memory::break_sharing(std::uint8_t* page_start, vm::page_table::entry_t& entry)
 {
-	
-	auto page_start = vm::virtual_memory::round_to_page(address);
+	const auto shared_flags = static_cast<vm::page_table::entry_t>(vm::page_table::copy_on_write | vm::page_table::demand_zero);
+	const auto flags = (entry & ~vm::page_table::address_mask & ~shared_flags) | vm::page_table::writable;
+
+	const auto frame = vm::page_table::frame(entry);
 
-	const auto search = this->address_space().find(page_start);
-	if (search == this->address_space().end())
+	// FRESH FRAMES ARE ALREADY ZERO, NOTHING TO COPY AND NO REFERENCE TO DROP
+	if (entry & vm::page_table::demand_zero)
 	{
-		
-		auto section = search->second;
-		auto page_count = section.get()->count();
-		
-		
-		for (size_t page_index = 0; page_index < page_count; page_index++)
-		{
-			this->address_space().erase(page_start + vm::virtual_memory::page_size * page_index);
-		}
+		entry = reinterpret_cast<vm::page_table::entry_t>(this->frames().allocate()) | flags;
+	}
+	// EVERY OTHER SHARER ALREADY MADE ITS OWN COPY, THE FRAME IS OURS ALONE
+	else if (this->frames().references(frame) == 1)
+	{
+		entry = reinterpret_cast<vm::page_table::entry_t>(frame) | flags;
+	}
+	else
+	{
+		const auto copy = this->frames().allocate();
+		std::memcpy(copy, frame, vm::virtual_memory::page_size);
+		this->frames().release(frame);
 
-		
-		return true;
+		entry = reinterpret_cast<vm::page_table::entry_t>(copy) | flags;
 	}
 
-	return false;
+	this->flush_tlb(page_start);
+}
+
+void vm::virtual_memory::code_written(std::uint8_t* page_start, vm::page_table::entry_t& entry)
+{
+	entry &= ~static_cast<vm::page_table::entry_t>(vm::page_table::code);
+	const auto generation = ++this->m_generations[page_start];
+
+	if (this->m_code_write_handler)
+		this->m_code_write_handler(page_start, generation);
+}
+
+vm::page_table& vm::virtual_memory::page_table()
+{
+	return this->m_page_table;
 }
 
-vm::virtual_memory::memory_map_t& vm::virtual_memory::address_space()
+vm::frame_allocator& vm::virtual_memory::frames()
 {
-	return this->m_address_space;
+	return *this->m_frames;
 }
@@ -1,13 +1,18 @@
 #pragma once
 
 // STD
+#include <array>
 #include <map>
 #include <memory>
 #include <algorithm>
+#include <functional>
 #include <type_traits>
+#include <unordered_map>
 
 // VM
-#include "virtual_section.hpp"
+#include "fault.hpp"
+#include "frame_allocator.hpp"
+#include "page_table.hpp"
 
 namespace vm
 {
@@ -15,178 +20,254 @@ namespace vm
 	{
 	public:
 		static constexpr const size_t page_size = 0x1000;
+		static_assert(vm::virtual_memory::page_size == vm::frame_allocator::frame_size);
 
+		virtual_memory() : m_frames(std::make_shared<vm::frame_allocator>()) {}
+
+		// GUEST FRAMES ARE CARVED FROM SLABS THE BACKEND PROVIDES
+		explicit virtual_memory(std::unique_ptr<vm::frame_backend> backend) : m_frames(std::make_shared<vm::frame_allocator>(std::move(backend))) {}
+
+		~virtual_memory();
+
+		virtual_memory(const virtual_memory&) = delete;
+		virtual_memory& operator=(const virtual_memory&) = delete;
+
+		// MAP EVERY PAGE OF PARENT INTO THIS (EMPTY) ADDRESS SPACE, SHARING THE FRAMES COPY-ON-WRITE
+		// ON BOTH SIDES. THE PARENT MUST NOT BE RUNNING WHILE IT IS CLONED
+		void clone_from(vm::virtual_memory& parent);
+
+		// MAPS EVERY PAGE TOUCHED BY [ADDRESS, ADDRESS + SIZE), FAILS IF ANY OF THEM IS ALREADY MAPPED
+		// PAGES ARE DEMAND-ZERO: READS SEE A SHARED ZERO FRAME, THE FIRST WRITE GIVES A PAGE ITS OWN FRAME
 		bool allocate(std::uint8_t* address, size_t size);
+
+		// UNMAPS THE WHOLE ALLOCATION STARTING ON THE ADDRESS'S PAGE
 		bool free(std::uint8_t* address);
 
-	
-	private:
-		using section_pointer_t = std::_Ptr_base<vm::virtual_section>::element_type*;
+		// DIRECT-MAPPED CACHE OF GUEST PAGE -> HOST PAGE, CONSULTED BEFORE THE PAGE TABLE
+		static constexpr size_t tlb_size = 0x40;
+		static_assert((tlb_size & (tlb_size - 1)) == 0, "tlb size must be a power of two");
 
-		template<typename T>
-		T handle_iterative_read(uint8_t* address, section_pointer_t section, const size_t& page_index)
+		enum tlb_permission : std::uint8_t
 		{
-			T result{};
+			tlb_read = 1 << 0,
 
-			auto page_address = address;
-			auto current_page_index = page_index;
+			// NEVER SET FOR CODE PAGES SO THEIR WRITES REACH THE SELF-MODIFYING CODE CHECK
+			tlb_write = 1 << 1
+		};
 
-			size_t buffer_offset = 0;
-			size_t bytes_left = sizeof(T);
+		void flush_tlb();
+		void flush_tlb(std::uint8_t* address);
 
-			
-			do
-			{
-				
-				const auto page_offset = vm::virtual_memory::get_page_offset(page_address);
-			
-				
-				const auto count_to_end = vm::virtual_memory::page_size - page_offset;
-				const auto bytes_read = std::min(page_offset == 0 ? vm::virtual_memory::page_size : count_to_end, bytes_left);
-
-				
-				auto page_buffer = reinterpret_cast<std::uint8_t*>(section->get(current_page_index));
-				for (auto i = 0; i < bytes_read; i++)
-				{
-					auto buffer = reinterpret_cast<std::uint8_t*>(&result);
-					buffer[buffer_offset + i] = page_buffer[page_offset + i];
-				}
-
-				page_address = nullptr;
+		bool mapped(std::uint8_t* address)
+		{
+			return this->find_page(address) != nullptr;
+		}
 
-				
-				buffer_offset += bytes_read;
+		// FLAG THE PAGE AS BACKING CACHED CODE, RETURNS FALSE IF IT IS NOT MAPPED
+		bool mark_code(std::uint8_t* address);
 
-				
-				bytes_left -= bytes_read;
+		// NUMBER OF TIMES CACHED CODE ON THE PAGE HAS BEEN OVERWRITTEN
+		std::uint32_t generation(std::uint8_t* address);
 
-				
-				++current_page_index;
+		// CALLED WITH THE PAGE START WHEN A WRITE LANDS ON A CODE PAGE, THE CODE FLAG IS CLEARED
+		// BEFOREHAND SO THE PAGE IS DATA AGAIN UNTIL SOMETHING RE-MARKS IT
+		using code_write_handler_t = std::function<void(std::uint8_t* page, std::uint32_t generation)>;
+		void set_code_write_handler(code_write_handler_t handler);
 
-			} while (bytes_left > 0);
+	private:
+		struct tlb_entry
+		{
+			std::uint8_t* page;
+			std::uint8_t* host;
+			std::uint8_t permissions;
+		};
 
-			return result;
-		}
-	
-		template<typename T>
-		void handle_iterative_write(T& value, uint8_t* address, section_pointer_t section)
+		tlb_entry& tlb_slot(std::uint8_t* page_start)
 		{
-			const auto buffer = reinterpret_cast<std::uint8_t*>(&value);
+			return this->m_tlb[(reinterpret_cast<std::uintptr_t>(page_start) / vm::virtual_memory::page_size) & (tlb_size - 1)];
+		}
 
-			
-			size_t buffer_offset = 0;
-			size_t bytes_left = sizeof(T);
-			auto current_page_index = vm::virtual_memory::get_page_index(address, section->base());
+		// HOST PAGE IF THE ACCESS STAYS WITHIN ONE PAGE AND THE TLB HOLDS IT WITH THE PERMISSION
+		template <typename T>
+		std::uint8_t* tlb_lookup(std::uint8_t* address, std::uint8_t permission)
+		{
+			const auto page_start = vm::virtual_memory::round_to_page(address);
+			if (vm::virtual_memory::get_page_offset(address) + sizeof(T) > vm::virtual_memory::page_size)
+				return nullptr;
 
-			
-			auto page_address = address;
-			do
-			{
-				
-				const auto page_offset = vm::virtual_memory::get_page_offset(page_address);
+			const auto& entry = this->tlb_slot(page_start);
+			if (entry.page != page_start || (entry.permissions & permission) == 0)
+				return nullptr;
 
-				
-				const auto count_to_end = vm::virtual_memory::page_size - page_offset;
-				const auto bytes_written = std::min(page_offset == 0 ? vm::virtual_memory::page_size : count_to_end, bytes_left);
+			return entry.host;
+		}
 
-				auto page_buffer = reinterpret_cast<std::uint8_t*>(section->get(current_page_index));
+		void tlb_fill(std::uint8_t* page_start, vm::page_table::entry_t entry);
 
-				for (auto i = 0; i < bytes_written; i++)
-				{
-					page_buffer[page_offset + i] = buffer[buffer_offset + i];
-				}
+		// DROP THE FRAME REFERENCE A PRESENT ENTRY HOLDS, DEMAND-ZERO ENTRIES HOLD NONE
+		void release_frame(vm::page_table::entry_t entry)
+		{
+			if ((entry & vm::page_table::demand_zero) == 0)
+				this->frames().release(vm::page_table::frame(entry));
+		}
 
-				page_address = nullptr;
+		// PRESENT LEAF ENTRY OF THE PAGE, NULLPTR IF UNMAPPED
+		vm::page_table::entry_t* find_page(std::uint8_t* address)
+		{
+			const auto entry = this->page_table().find(address);
+			if (entry == nullptr || (*entry & vm::page_table::present) == 0)
+				return nullptr;
 
-				
-				buffer_offset += bytes_written;
+			return entry;
+		}
 
-				
-				bytes_left -= bytes_written;
+		// AS FIND_PAGE, BUT FIRST GIVES A COPY-ON-WRITE OR DEMAND-ZERO PAGE A FRAME OF ITS OWN
+		vm::page_table::entry_t* writable_page(std::uint8_t* address)
+		{
+			const auto entry = this->find_page(address);
+			if (entry != nullptr && (*entry & vm::page_table::copy_on_write))
+				this->break_sharing(vm::virtual_memory::round_to_page(address), *entry);
 
-				
-				++current_page_index;
-			} while (bytes_left > 0);
+			return entry;
 		}
 
-	public:
-		template <typename T>
-		T read(std::uint8_t* address)
+		// COLD PATH OF WRITABLE_PAGE, ALSO MATERIALISES DEMAND-ZERO PAGES
+		void break_sharing(std::uint8_t* page_start, vm::page_table::entry_t& entry);
+
+		// CALLS VISIT(HOST, OFFSET, LENGTH) ONCE PER HOST-CONTIGUOUS RUN OF [ADDRESS, ADDRESS + SIZE),
+		// ADJACENT GUEST PAGES CARVED FROM THE SAME SLAB MERGE INTO ONE RUN
+		// WRITES CHECK EVERY PAGE IS MAPPED BEFORE TOUCHING ANY, SO A FAULTING WRITE CHANGES NOTHING
+		template <bool Write, typename Visit>
+		vm::fault walk(std::uint8_t* address, size_t size, Visit&& visit)
 		{
-			
-			auto page_start = vm::virtual_memory::round_to_page(address);
+			if constexpr (Write)
+			{
+				if (const auto fault = this->check_mapped(address, size))
+					return fault;
+			}
 
-			
-			const auto search = this->address_space().find(page_start);
-			if (search != this->address_space().end())
+			std::uint8_t* run_host = nullptr;
+			size_t run_offset = 0;
+			size_t run_length = 0;
+
+			size_t offset = 0;
+			while (offset < size)
 			{
-				auto section = search->second.get();
+				const auto current = address + offset;
+				const auto page_start = vm::virtual_memory::round_to_page(current);
+				const auto page_offset = vm::virtual_memory::get_page_offset(current);
+
+				const auto entry = Write ? this->writable_page(page_start) : this->find_page(page_start);
+				if (entry == nullptr)
+				{
+					if (run_length != 0)
+						visit(run_host, run_offset, run_length);
 
-				const auto page_index = vm::virtual_memory::get_page_index(page_start, section->base());
+					return vm::fault{ vm::fault_code::page_fault, current, nullptr };
+				}
 
-				const size_t buffer_size = sizeof(T);
+				this->tlb_fill(page_start, *entry);
 
-				
-				const auto next_page_start = page_start + vm::virtual_memory::page_size;
-				const bool exceeds_page = (address + sizeof(T) ) >= next_page_start;
+				const auto host = vm::page_table::frame(*entry) + page_offset;
+				const auto length = std::min(vm::virtual_memory::page_size - page_offset, size - offset);
 
-				if (!exceeds_page)
+				if (run_length != 0 && run_host + run_length == host)
 				{
-					const auto page_offset = vm::virtual_memory::get_page_offset(address);
-					return *reinterpret_cast<T*>(section->get(page_index) + page_offset);
+					run_length += length;
 				}
 				else
 				{
-					return handle_iterative_read<T>(address, section, page_index);
+					if (run_length != 0)
+						visit(run_host, run_offset, run_length);
+
+					run_host = host;
+					run_offset = offset;
+					run_length = length;
+				}
+
+				offset += length;
+
+				if constexpr (Write)
+				{
+					// THE BYTES MUST BE IN PLACE BEFORE ANYONE IS TOLD THE CODE CHANGED
+					if (*entry & vm::page_table::code)
+					{
+						visit(run_host, run_offset, run_length);
+						run_length = 0;
+
+						this->code_written(page_start, *entry);
+						this->tlb_fill(page_start, *entry);
+					}
 				}
 			}
 
-			throw std::exception("Pagefault");
+			if (run_length != 0)
+				visit(run_host, run_offset, run_length);
+
+			return vm::fault{};
 		}
 
+		vm::fault check_mapped(std::uint8_t* address, size_t size);
+
+		// COLD PATH OF WRITE, ONLY REACHED FOR PAGES WITH CACHED CODE
+		void code_written(std::uint8_t* page_start, vm::page_table::entry_t& entry);
+
+	public:
 		template <typename T>
-		void write(T& value, std::uint8_t* address)
+		vm::fault read(std::uint8_t* address, T& value)
 		{
-			
-			const auto page_start = vm::virtual_memory::round_to_page(address);
-
-			
-			const auto search = this->address_space().find(page_start);
-			if (search != this->address_space().end())
+			if (const auto host = this->tlb_lookup<T>(address, tlb_read))
 			{
-				auto section = search->second.get();
+				value = *reinterpret_cast<T*>(host + vm::virtual_memory::get_page_offset(address));
+				return vm::fault{};
+			}
 
-				
-				const auto next_page_start = page_start + vm::virtual_memory::page_size;
-				const bool exceeds_page = (address + sizeof(T)) >= next_page_start;
+			return this->read_block(address, &value, sizeof(T));
+		}
 
-				if (!exceeds_page)
-				{
-					const auto page_index = vm::virtual_memory::get_page_index(address, section->base());
-					const auto page_offset = vm::virtual_memory::get_page_offset(address);
+		// THROWING CONVENIENCE FOR EMBEDDERS, HANDLERS USE THE FAULT-RETURNING OVERLOAD
+		template <typename T>
+		T read(std::uint8_t* address)
+		{
+			T value{};
+			if (this->read(address, value))
+				throw std::exception("Pagefault");
 
-					*reinterpret_cast<T*>(section->get(page_index) + page_offset) = value;
-				}
-				else
-				{
-					handle_iterative_write(value, address, section);
-				}
+			return value;
+		}
 
-				return;
+		template <typename T>
+		vm::fault write(T& value, std::uint8_t* address)
+		{
+			if (const auto host = this->tlb_lookup<T>(address, tlb_write))
+			{
+				*reinterpret_cast<T*>(host + vm::virtual_memory::get_page_offset(address)) = value;
+				return vm::fault{};
 			}
 
-			throw std::exception("Pagefault");
-			return;
+			return this->write_block(address, &value, sizeof(T));
 		}
 
-		using memory_map_t = std::map<std::uint8_t*, std::shared_ptr<vm::virtual_section>>;
-		memory_map_t& address_space();
+		// BULK TRANSFERS, ONE MEMCPY/MEMSET PER HOST-CONTIGUOUS RUN INSTEAD OF PER BYTE OR PER VALUE
+		vm::fault read_block(std::uint8_t* address, void* destination, size_t size);
+		vm::fault write_block(std::uint8_t* address, const void* source, size_t size);
+		vm::fault fill(std::uint8_t* address, std::uint8_t value, size_t size);
+
+		// MEMMOVE SEMANTICS, OVERLAPPING GUEST RANGES ARE FINE
+		vm::fault copy_within(std::uint8_t* destination, std::uint8_t* source, size_t size);
+
+		// MEMCMP-STYLE RESULT IN RESULT: GUEST AGAINST A HOST BUFFER, OR TWO GUEST RANGES
+		vm::fault compare(std::uint8_t* address, const void* data, size_t size, int& result);
+		vm::fault compare_within(std::uint8_t* first, std::uint8_t* second, size_t size, int& result);
+
+		vm::page_table& page_table();
+		vm::frame_allocator& frames();
 
 	private:
 		template <typename T>
 		static constexpr T round_to_page(T address)
 		{
-			
+
 			return reinterpret_cast<T>(reinterpret_cast<std::uint64_t>(address) & ~(0xFFF));
 		}
 
@@ -195,13 +276,18 @@ namespace vm
 		{
 			return reinterpret_cast<std::uintptr_t>(address) & (0xFFF);
 		}
-		template <typename T>
-		static constexpr size_t get_page_index(T address, T base_address)
-		{
-			const auto page_delta = vm::virtual_memory::round_to_page(address) - vm::virtual_memory::round_to_page(base_address);
-			return page_delta / vm::virtual_memory::page_size;
-		}
 
-		memory_map_t m_address_space;
+		// SHARED WITH CLONES, FRAMES MUST OUTLIVE EVERY ADDRESS SPACE THAT MAPS THEM
+		std::shared_ptr<vm::frame_allocator> m_frames;
+		vm::page_table m_page_table;
+
+		// FIRST PAGE -> PAGE COUNT OF EVERY ALLOCATION, SO FREE KNOWS WHAT TO UNMAP
+		std::map<std::uint8_t*, size_t> m_allocations;
+
+		// ONLY PAGES WHOSE CACHED CODE WAS EVER OVERWRITTEN HAVE AN ENTRY
+		std::unordered_map<std::uint8_t*, std::uint32_t> m_generations;
+
+		code_write_handler_t m_code_write_handler;
+		std::array<tlb_entry, tlb_size> m_tlb{};
 	};
-}
\ No newline at end of file
+}
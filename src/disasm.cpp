@@ -1,5 +1,6 @@
 // STD
 #include <algorithm>
+#include <array>
 
 // x86
 #include "disasm.hpp"
@@ -8,10 +9,14 @@
 #include "instruction_opcode.hpp"
 #include "instruction_operand.hpp"
 #include "instruction_modrm.hpp"
+#include "instruction_vex.hpp"
+#include "instruction_dispatch.hpp"
+#include "instruction_spec.hpp"
 
 std::uint8_t* x86::disassembler::buffer()
 {
-	return this->m_buffer.data();
+	// CODE IS ONLY EVER READ, THE POINTER TYPE MATCHES THE INSTRUCTION POINTER
+	return const_cast<std::uint8_t*>(this->m_buffer.data());
 }
 
 size_t x86::disassembler::buffer_size()
@@ -19,10 +24,98 @@ size_t x86::disassembler::buffer_size()
 	return this->m_buffer.size();
 }
 
+bool x86::disassembler::decode(x86::instruction& instr, std::uint8_t*& instruction_pointer, size_t remaining)
+{
+	if (remaining >= x86::disassembler::max_decode_read)
+	{
+		x86::disassembler::decode_unchecked(instr, instruction_pointer);
+		return true;
+	}
+
+	// NEAR THE END OF THE CODE: DECODE A ZERO-PADDED COPY SO NOTHING PAST THE END IS READ
+	std::array<std::uint8_t, x86::disassembler::max_decode_read> window{};
+	std::copy_n(instruction_pointer, remaining, window.begin());
+
+	auto pointer = window.data();
+	x86::disassembler::decode_unchecked(instr, pointer);
+
+	const auto consumed = static_cast<size_t>(pointer - window.data());
+	if (consumed <= remaining)
+	{
+		instruction_pointer += consumed;
+		return true;
+	}
+
+	instr = x86::instruction{};
+	instr.size() = static_cast<std::uint8_t>(remaining);
+	instr.handler() = x86::dispatch::truncated;
+	instruction_pointer += remaining;
+
+	return false;
+}
+
+void x86::disassembler::decode_unchecked(x86::instruction& instr, std::uint8_t*& instruction_pointer)
+{
+	auto start = instruction_pointer;
+
+	
+	if (!instr.prefix_initialised())
+	{
+		
+		x86::disassembler::handle_prefix(instr, instruction_pointer);
+	}
+
+	// VEX AND EVEX REPLACE BOTH REX AND THE OPCODE ESCAPE BYTES
+	if (!instr.rex_initialised() && x86::vex::is(*instruction_pointer))
+	{
+		x86::disassembler::handle_vex(instr, instruction_pointer);
+	}
+
+	
+	if (!instr.rex_initialised())
+	{
+		// HANDLE REX PREFIX
+		x86::disassembler::handle_rex(instr, instruction_pointer);
+	}
+
+	
+	if (!instr.opcode_initialised())
+	{
+		x86::disassembler::handle_opcode(instr, instruction_pointer);
+	}
+
+	
+	if (!instr.operand_initialised())
+	{
+		x86::disassembler::handle_operand(instr, instruction_pointer);
+	}
+
+	
+	instr.size() = static_cast<std::uint8_t>(instruction_pointer - start);
+
+	
+	instr.handler() = x86::dispatch::resolve(instr);
+}
+
 void x86::disassembler::handle_opcode(x86::instruction& instr, std::uint8_t*& buffer)
 {
 	
-	instr.opcode().buffer().emplace_back(*buffer);
+	instr.opcode().buffer().append(*buffer);
+
+	// TWO-BYTE ESCAPE
+	if (*buffer == 0x0F)
+	{
+		++buffer;
+		instr.opcode().buffer().append(*buffer);
+
+		// THREE-BYTE ESCAPES
+		if (*buffer == 0x38 || *buffer == 0x3A)
+		{
+			++buffer;
+			instr.opcode().buffer().append(*buffer);
+		}
+	}
+
 	++buffer;
 
 	
@@ -32,34 +125,81 @@ void x86::disassembler::handle_opcode(x86::instruction& instr, std::uint8_t*& bu
 void x86::disassembler::handle_operand(x86::instruction& instr, std::uint8_t*& buffer)
 {
 	
-	const auto search = x86::operand::info.find(instr.opcode().as<std::uint32_t>());
+	const auto& spec = x86::spec::find(instr);
+	if (!spec.valid)
+	{
+		instr.operand_initialised() = true;
+		return;
+	}
 
 	
-	if (search != x86::operand::info.end())
+	size_t size = 0;
+	auto immediate_kind = spec.immediate;
+
+	if (spec.modrm)
 	{
-		
-		const auto info = search->second;
-		auto size = info.size;
+		auto modrm = *reinterpret_cast<x86::modrm*>(buffer);
+		instr.modrm() = modrm;
+		size += 1;
 
 		
-		if (info.modrm)
+		instr.displacement_size() = modrm.data_size();
+
+		if (modrm.has_sib())
 		{
-			size += reinterpret_cast<x86::modrm*>(buffer)->data_size();
+			const auto sib = *reinterpret_cast<x86::sib*>(buffer + 1);
+			instr.sib() = sib;
+			size += 1;
+
+			
+			if (!sib.has_base(modrm.mode))
+				instr.displacement_size() = 4;
 		}
 
-		
-		for (size_t i = 0; i < size; i++, buffer++)
-			instr.operand().buffer().emplace_back(*buffer);
+		size += instr.displacement_size();
+
+		// SOME GROUP EXTENSIONS (F6 /0, F7 /0) CARRY AN IMMEDIATE THE OPCODE ITSELF DOES NOT
+		if (immediate_kind == x86::spec::immediate::none)
+			immediate_kind = x86::spec::extension(spec, modrm.reg).immediate;
+	}
+
+	const auto immediate_size = x86::spec::immediate_size(
+		immediate_kind,
+		x86::spec::operand_size(spec, instr),
+		x86::spec::address_size(instr));
+	size += immediate_size;
+
+	
+	for (size_t i = 0; i < size; i++, buffer++)
+		instr.operand().buffer().append(*buffer);
+
+	
+	const auto displacement_offset = (spec.modrm ? 1 : 0) + (instr.sib().has_value() ? 1 : 0);
+	switch (instr.displacement_size())
+	{
+	case 1:
+		instr.displacement() = instr.operand().get<std::int8_t>(displacement_offset);
+		break;
+	case 4:
+		instr.displacement() = instr.operand().get<std::int32_t>(displacement_offset);
+		break;
 	}
 
 	
+	const auto immediate_offset = displacement_offset + instr.displacement_size();
+	for (size_t i = 0; i < immediate_size; i++)
+		instr.immediate() |= static_cast<std::uint64_t>(instr.operand().buffer().at(immediate_offset + i)) << (8 * i);
+
+	instr.immediate_size() = immediate_size;
+
+	
 	instr.operand_initialised() = true;
 }
 
 void x86::disassembler::handle_prefix(x86::instruction& instr, std::uint8_t*& buffer)
 {
 	
-	for (size_t i = 0; i < 4; i++)
+	for (size_t i = 0; i < x86::disassembler::max_instruction_size - 1; i++)
 	{
 		
 		if (x86::prefix::is(*buffer))
@@ -69,11 +209,16 @@ void x86::disassembler::handle_prefix(x86::instruction& instr, std::uint8_t*& bu
 			++buffer;
 			continue;
 		}
-		else
+
+		// A REX BYTE ONLY COUNTS DIRECTLY BEFORE THE OPCODE, ONE FOLLOWED BY ANOTHER PREFIX IS IGNORED
+		if ((*buffer & 0xF0) == 0x40 && x86::prefix::is(buffer[1]))
 		{
-			
-			break;
+			++buffer;
+			continue;
 		}
+
+		
+		break;
 	}
 
 	
@@ -97,3 +242,88 @@ void x86::disassembler::handle_rex(x86::instruction& instr, std::uint8_t*& buffe
 
 	instr.rex_initialised() = true;
 }
+
+void x86::disassembler::handle_vex(x86::instruction& instr, std::uint8_t*& buffer)
+{
+	x86::vex vex{};
+	x86::rex rex{};
+	rex.id = 0x04;
+
+	// R, X, B, VVVV AND R' ARE STORED INVERTED
+	const std::uint8_t first = buffer[1];
+	switch (buffer[0])
+	{
+	// C5 [R VVVV L PP]
+	case 0xC5:
+	{
+		rex.r = (~first >> 7) & 1;
+		vex.vvvv = (~first >> 3) & 0xF;
+		vex.length = (first >> 2) & 1;
+		vex.pp = first & 3;
+		vex.map = 1;
+		vex.size = 2;
+		break;
+	}
+	// C4 [R X B MMMMM] [W VVVV L PP]
+	case 0xC4:
+	{
+		const std::uint8_t second = buffer[2];
+		rex.r = (~first >> 7) & 1;
+		rex.x = (~first >> 6) & 1;
+		rex.b = (~first >> 5) & 1;
+		rex.w = (second >> 7) & 1;
+		vex.map = first & 0x1F;
+		vex.vvvv = (~second >> 3) & 0xF;
+		vex.length = (second >> 2) & 1;
+		vex.pp = second & 3;
+		vex.size = 3;
+		break;
+	}
+	// 62 [R X B R' 0 MMM] [W VVVV 1 PP] [Z L'L B V' AAA]
+	default:
+	{
+		const std::uint8_t second = buffer[2];
+		const std::uint8_t third = buffer[3];
+		rex.r = (~first >> 7) & 1;
+		rex.x = (~first >> 6) & 1;
+		rex.b = (~first >> 5) & 1;
+		rex.w = (second >> 7) & 1;
+		vex.map = first & 0x07;
+		vex.vvvv = (~second >> 3) & 0xF;
+		vex.pp = second & 3;
+		vex.zeroing = (third >> 7) & 1;
+		vex.length = (third >> 5) & 3;
+		vex.broadcast = (third >> 4) & 1;
+		vex.opmask = third & 7;
+		vex.size = 4;
+		break;
+	}
+	}
+
+	buffer += vex.size;
+
+	instr.vex() = vex;
+	instr.rex() = rex;
+	instr.rex_initialised() = true;
+
+	// IMPLIED ESCAPE BYTES, SO THE SPEC TABLES SEE THE SAME OPCODE AS THE LEGACY ENCODING
+	switch (vex.map)
+	{
+	case 1:
+		instr.opcode().buffer().append(0x0F);
+		break;
+	case 2:
+		instr.opcode().buffer().append(0x0F);
+		instr.opcode().buffer().append(0x38);
+		break;
+	case 3:
+		instr.opcode().buffer().append(0x0F);
+		instr.opcode().buffer().append(0x3A);
+		break;
+	}
+
+	instr.opcode().buffer().append(*buffer);
+	++buffer;
+
+	instr.opcode_initialised() = true;
+}
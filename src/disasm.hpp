@@ -1,8 +1,7 @@
 #pragma once
 
 // STD
-#include <vector>
-#include <initializer_list>
+#include <span>
 
 // x86
 #include "instruction.hpp"
@@ -12,10 +11,11 @@ namespace x86
 	class disassembler
 	{
 	public:
+		// NON-OWNING, THE CALLER KEEPS THE CODE ALIVE FOR THE LIFETIME OF THE DISASSEMBLER
 		template <class T, size_t N>
-		disassembler(T(&buffer)[N]) : m_buffer(buffer, buffer + N) {}
+		disassembler(T(&buffer)[N]) : m_buffer(buffer, N) {}
 
-		disassembler(std::vector<std::uint8_t> buffer) : m_buffer(buffer) {}
+		disassembler(std::span<const std::uint8_t> buffer) : m_buffer(buffer) {}
 
 		
 		std::uint8_t* buffer();
@@ -25,55 +25,41 @@ namespace x86
 		template <class T, class Fn>
 		void iterate(T offset, Fn callback)
 		{
+			const auto buffer_end = this->buffer() + this->buffer_size();
 			for (auto instruction_pointer = this->buffer() + offset; 
-				instruction_pointer < this->buffer() + this->buffer_size();)
+				instruction_pointer < buffer_end;)
 			{
 				x86::instruction instr{};
-
-				auto start = instruction_pointer;
-
-				
-				if (!instr.prefix_initialised())
-				{
-					
-					x86::disassembler::handle_prefix(instr, instruction_pointer);
-				}
-
-				
-				if (!instr.rex_initialised())
-				{
-					// HANDLE REX PREFIX
-					x86::disassembler::handle_rex(instr, instruction_pointer);
-				}
-
-				
-				if (!instr.opcode_initialised())
-				{
-					x86::disassembler::handle_opcode(instr, instruction_pointer);
-				}
-
-				
-				if (!instr.operand_initialised())
-				{
-					x86::disassembler::handle_operand(instr, instruction_pointer);
-				}
-
-				
-				instr.size() = static_cast<std::uint8_t>(instruction_pointer - start);
+				x86::disassembler::decode(instr, instruction_pointer, static_cast<size_t>(buffer_end - instruction_pointer));
 
 				
 				callback(instr, instruction_pointer);
 			}
 		}
 
+		// ARCHITECTURAL LIMIT, LONGER ENCODINGS RAISE #UD
+		static constexpr size_t max_instruction_size = 15;
+
+		// MALFORMED ENCODINGS (E.G. 14 PREFIXES IN FRONT OF A VEX INSTRUCTION) CAN MAKE THE DECODER
+		// LOOK FURTHER THAN MAX_INSTRUCTION_SIZE, BUT NEVER THIS FAR
+		static constexpr size_t max_decode_read = 0x40;
+
+		// DECODE A SINGLE INSTRUCTION FROM AT MOST REMAINING BYTES AND ADVANCE THE POINTER PAST IT
+		// AN ENCODING CUT OFF BY THE END BECOMES ONE TRUNCATED INSTRUCTION COVERING EVERY REMAINING
+		// BYTE, DISPATCHED TO A HANDLER THAT FAULTS, AND DECODE RETURNS FALSE
+		static bool decode(x86::instruction& instr, std::uint8_t*& instruction_pointer, size_t remaining);
+
 	private:
+		// NO BOUNDS CHECKS, THE CALLER GUARANTEES MAX_DECODE_READ READABLE BYTES
+		static void decode_unchecked(x86::instruction& instr, std::uint8_t*& instruction_pointer);
 
 		
 		static void handle_opcode(x86::instruction& instr, std::uint8_t*& buffer);
 		static void handle_operand(x86::instruction& instr, std::uint8_t*& buffer);
 		static void handle_prefix(x86::instruction& instr, std::uint8_t*& buffer);
 		static void handle_rex(x86::instruction& instr, std::uint8_t*& buffer);
+		static void handle_vex(x86::instruction& instr, std::uint8_t*& buffer);
 
-		std::vector<std::uint8_t> m_buffer;
+		std::span<const std::uint8_t> m_buffer;
 	};
 }
\ No newline at end of file
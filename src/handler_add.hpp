@@ -1,7 +1,10 @@
 #pragma once
 
+// STD
+#include <type_traits>
 
 #include "instruction.hpp"
+#include "numerical_helper.hpp"
 
 #include "virtual_machine.hpp"
 
@@ -13,24 +16,66 @@ namespace vm::handler::add
 		void handle_flags(virtual_machine* vm, T value, T previous_value, T addition)
 		{
 			
-			vm->context().flags().zero = value == 0x000;
+			vm->context().record_flags(x86::registr::operation::add, previous_value, addition, value);
+		}
 
-			
-			vm->context().flags().overflow =
-				numerical_helper::addition_overflows(value, addition);
 
-			
-			vm->context().flags().carry =
-				numerical_helper::is_signed(value) != numerical_helper::is_signed(previous_value);
+		template <class T>
+		T& register_as(x86::registr::register_data& data)
+		{
+			if constexpr (sizeof(T) == sizeof(std::uint16_t))
+				return data.word;
+			else if constexpr (sizeof(T) == sizeof(std::uint32_t))
+				return data.dword;
+			else
+				return data.qword;
+		}
 
-			
-			vm->context().flags().sign = numerical_helper::is_signed(value) ? 1 : 0;
+		// 32-BIT REGISTER WRITES ZERO THE UPPER HALF
+		template <class T>
+		void register_write(x86::registr::register_data& data, T value)
+		{
+			if constexpr (sizeof(T) == sizeof(std::uint32_t))
+				data.qword = value;
+			else
+				vm::handler::add::impl::register_as<T>(data) = value;
+		}
 
-			
-			const auto set_bit_count = numerical_helper::least_significant_bits(value);
-			vm->context().flags().parity = set_bit_count % 2 == 0; 
+		// [BASE + INDEX * SCALE + DISP] OR [RIP + DISP32], TRUNCATED TO THE ADDRESS SIZE
+		template <class AddressT, std::uint8_t Mode>
+		std::uint8_t* effective_address(virtual_machine* vm, x86::instruction& instr)
+		{
+			static_assert(Mode < 3, "register operands have no effective address");
+
+			const auto modrm = instr.modrm().value();
+			const auto rex = instr.rex().value_or(x86::rex{});
+
+			std::uint64_t address = 0;
+			if (Mode == 0 && modrm.rip_relative())
+			{
+				// THE INSTRUCTION POINTER ALREADY POINTS PAST THIS INSTRUCTION
+				address = reinterpret_cast<std::uint64_t>(vm->context().instruction_pointer());
+			}
+			else if (instr.sib().has_value())
+			{
+				const auto sib = instr.sib().value();
+
+				if (sib.has_base(Mode))
+					address = vm->context().get(sib.base | (rex.b << 3)).qword;
+
+				// INDEX 100 WITHOUT REX.X MEANS NO INDEX
+				const std::uint8_t index = sib.index | (rex.x << 3);
+				if (index != 4)
+					address += vm->context().get(index).qword << sib.scale;
+			}
+			else
+			{
+				address = vm->context().get(modrm.rm | (rex.b << 3)).qword;
+			}
+
+			address += static_cast<std::int64_t>(instr.displacement());
+
+			return reinterpret_cast<std::uint8_t*>(static_cast<std::uint64_t>(static_cast<AddressT>(address)));
 		}
 	}
-
-	void handle(virtual_machine* vm, x86::instruction& instr);
-}
\ No newline at end of file
+}
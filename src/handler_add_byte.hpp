@@ -8,5 +8,5 @@
 
 namespace vm::handler::add
 {
-	void byte(virtual_machine* vm, x86::instruction& instr);
+	vm::fault byte(virtual_machine* vm, x86::instruction& instr);
 }
\ No newline at end of file
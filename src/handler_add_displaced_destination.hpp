@@ -5,41 +5,46 @@
 
 // VM
 #include "virtual_machine.hpp"
+#include "handler_add.hpp"
 
 namespace vm::handler::add
 {
-	namespace impl
+	// ADD Ev, Iz
+	template <class OperandT, class AddressT, std::uint8_t Mode>
+	vm::fault displaced_destination(virtual_machine* vm, x86::instruction& instr)
 	{
-		void displaced_destination_zero(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition,
-			bool& derefence);
-
-		void displaced_destination_one(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition,
-			uint64_t& offset,
-			bool& derefence);
-
-		void displaced_destination_two(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition,
-			uint64_t& offset,
-			bool& derefence);
-
-		void displaced_destination_three(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition,
-			bool& derefence);
-	}
+		auto modifier = instr.get_modifier(0);
+
+		// IMM32, SIGN-EXTENDED TO THE OPERAND SIZE
+		const auto addition = static_cast<OperandT>(
+			static_cast<std::int64_t>(static_cast<std::int32_t>(instr.immediate())));
+
+
+		if constexpr (Mode == 3)
+		{
+			auto& destination_reg = vm->context().get(modifier.source_register);
+			const auto previous_value = vm::handler::add::impl::register_as<OperandT>(destination_reg);
+			const OperandT value = previous_value + addition;
+			vm::handler::add::impl::register_write(destination_reg, value);
+
 
-	void displaced_destination(virtual_machine* vm, x86::instruction& instr);
-}
\ No newline at end of file
+			vm::handler::add::impl::handle_flags(vm, value, previous_value, addition);
+		}
+		else
+		{
+			const auto address = vm::handler::add::impl::effective_address<AddressT, Mode>(vm, instr);
+			OperandT previous_value;
+			if (const auto fault = vm->memory().read(address, previous_value))
+				return fault;
+
+			OperandT value = previous_value + addition;
+			if (const auto fault = vm->memory().write(value, address))
+				return fault;
+
+
+			vm::handler::add::impl::handle_flags(vm, value, previous_value, addition);
+		}
+
+		return vm::fault{};
+	}
+}
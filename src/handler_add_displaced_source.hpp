@@ -5,34 +5,38 @@
 
 // VM
 #include "virtual_machine.hpp"
+#include "handler_add.hpp"
 
 namespace vm::handler::add
 {
-	namespace impl
+	// ADD Gv, Ev
+	template <class OperandT, class AddressT, std::uint8_t Mode>
+	vm::fault displaced_source(virtual_machine* vm, x86::instruction& instr)
 	{
-		void displaced_source_zero(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition);
-
-		void displaced_source_one(
-			virtual_machine* vm, 
-			x86::instruction::modifier_data_t& modifier, 
-			x86::instruction& instr, 
-			uint64_t& addition);
-
-		void displaced_source_two(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition);
-
-		void displaced_source_three(
-			virtual_machine* vm,
-			x86::instruction::modifier_data_t& modifier,
-			x86::instruction& instr,
-			uint64_t& addition);
+		auto modifier = instr.get_modifier(0);
+
+
+		OperandT addition;
+		if constexpr (Mode == 3)
+		{
+			addition = vm::handler::add::impl::register_as<OperandT>(vm->context().get(modifier.source_register));
+		}
+		else
+		{
+			const auto address = vm::handler::add::impl::effective_address<AddressT, Mode>(vm, instr);
+			if (const auto fault = vm->memory().read(address, addition))
+				return fault;
+		}
+
+
+		auto& destination_reg = vm->context().get(modifier.destination_register);
+		const auto previous_value = vm::handler::add::impl::register_as<OperandT>(destination_reg);
+		const OperandT value = previous_value + addition;
+		vm::handler::add::impl::register_write(destination_reg, value);
+
+
+		vm::handler::add::impl::handle_flags(vm, value, previous_value, addition);
+
+		return vm::fault{};
 	}
-	void displaced_source(virtual_machine* vm, x86::instruction& instr);
-}
\ No newline at end of file
+}
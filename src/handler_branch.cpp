@@ -0,0 +1,87 @@
+#include "handler_branch.hpp"
+
+namespace
+{
+	// SIGN-EXTENDED DISPLACEMENT, THE INSTRUCTION POINTER ALREADY POINTS PAST THE INSTRUCTION
+	std::uint8_t* relative_target(virtual_machine* vm, x86::instruction& instr)
+	{
+		const auto shift = 64 - instr.immediate_size() * 8;
+		const auto displacement = static_cast<std::int64_t>(instr.immediate() << shift) >> shift;
+
+		return vm->context().instruction_pointer() + displacement;
+	}
+
+	// NOTHING HAS CHANGED WHEN THIS IS RETURNED, THE HANDLER MAY REDIRECT OR STOP
+	vm::fault invalid_target(std::uint8_t* target)
+	{
+		return vm::fault{ vm::fault_code::invalid_target, target, nullptr };
+	}
+}
+
+vm::fault vm::handler::branch::jump(virtual_machine* vm, x86::instruction& instr)
+{
+	const auto target = relative_target(vm, instr);
+	if (!vm->valid_target(target))
+		return invalid_target(target);
+
+	vm->context().instruction_pointer() = target;
+	return vm::fault{};
+}
+
+vm::fault vm::handler::branch::jump_conditional(virtual_machine* vm, x86::instruction& instr)
+{
+	// 7X AND 0F 8X BOTH KEEP THE CONDITION IN THE LOW NIBBLE
+	auto& opcode = instr.opcode().buffer();
+	const auto condition = static_cast<std::uint8_t>(opcode.at(opcode.size() - 1) & 0x0F);
+
+	if (!vm->context().condition(condition))
+		return vm::fault{};
+
+	const auto target = relative_target(vm, instr);
+	if (!vm->valid_target(target))
+		return invalid_target(target);
+
+	vm->context().instruction_pointer() = target;
+	return vm::fault{};
+}
+
+vm::fault vm::handler::branch::call(virtual_machine* vm, x86::instruction& instr)
+{
+	auto& stack_pointer = vm->context().get(x86::registr::id::rsp);
+
+	const auto target = relative_target(vm, instr);
+	if (!vm->valid_target(target))
+		return invalid_target(target);
+
+	
+	auto return_address = reinterpret_cast<std::uint64_t>(vm->context().instruction_pointer());
+	if (const auto fault = vm->memory().write(return_address, stack_pointer.ptr - sizeof(return_address)))
+		return fault;
+
+	stack_pointer.qword -= sizeof(return_address);
+	vm->context().instruction_pointer() = target;
+	vm->predict_return(reinterpret_cast<std::uint8_t*>(return_address));
+
+	return vm::fault{};
+}
+
+vm::fault vm::handler::branch::ret(virtual_machine* vm, x86::instruction& instr)
+{
+	auto& stack_pointer = vm->context().get(x86::registr::id::rsp);
+
+	
+	std::uint64_t return_address;
+	if (const auto fault = vm->memory().read(stack_pointer.ptr, return_address))
+		return fault;
+
+	// THE GUEST CONTROLS ITS STACK, THE RETURN ADDRESS CAN BE ANYTHING
+	const auto target = reinterpret_cast<std::uint8_t*>(return_address);
+	if (!vm->valid_target(target))
+		return invalid_target(target);
+
+	// RET IMM16 ALSO RELEASES THE CALLEE'S ARGUMENT BYTES
+	stack_pointer.qword += sizeof(return_address) + static_cast<std::uint16_t>(instr.immediate());
+	vm->context().instruction_pointer() = target;
+
+	return vm::fault{};
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// X86
+#include "instruction.hpp"
+
+// VM
+#include "virtual_machine.hpp"
+
+namespace vm::handler::branch
+{
+	// JMP REL8/REL32
+	vm::fault jump(virtual_machine* vm, x86::instruction& instr);
+
+	// JCC REL8/REL32
+	vm::fault jump_conditional(virtual_machine* vm, x86::instruction& instr);
+
+	// CALL REL32
+	vm::fault call(virtual_machine* vm, x86::instruction& instr);
+
+	// RET, RET IMM16
+	vm::fault ret(virtual_machine* vm, x86::instruction& instr);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// STD
+#include <array>
+#include <type_traits>
+#include <utility>
+
+// x86
+#include "instruction.hpp"
+#include "instruction_dispatch.hpp"
+
+// VM
+#include "handler_add_byte.hpp"
+#include "handler_add_displaced_source.hpp"
+#include "handler_add_displaced_destination.hpp"
+#include "handler_branch.hpp"
+#include "handler_unknown.hpp"
+
+namespace vm::handler
+{
+	using handler_t = vm::fault(*)(virtual_machine* vm, x86::instruction& instr);
+	using table_t = std::array<handler_t, x86::dispatch::END_OF_HANDLER>;
+
+	namespace impl
+	{
+		template <std::size_t Bytes>
+		using unsigned_t = std::conditional_t<Bytes == 2, std::uint16_t,
+			std::conditional_t<Bytes == 4, std::uint32_t, std::uint64_t>>;
+
+		template <std::uint16_t Variant>
+		using operand_t = unsigned_t<x86::dispatch::variant::operand_size(Variant)>;
+
+		template <std::uint16_t Variant>
+		using address_t = unsigned_t<x86::dispatch::variant::address_size(Variant)>;
+
+		
+		template <std::uint16_t... Variants>
+		constexpr void fill_add(table_t& table, std::integer_sequence<std::uint16_t, Variants...>)
+		{
+			((table[x86::dispatch::add_displaced_source + Variants] =
+				&vm::handler::add::displaced_source<operand_t<Variants>, address_t<Variants>, x86::dispatch::variant::mode(Variants)>), ...);
+
+			((table[x86::dispatch::add_displaced_destination + Variants] =
+				&vm::handler::add::displaced_destination<operand_t<Variants>, address_t<Variants>, x86::dispatch::variant::mode(Variants)>), ...);
+		}
+	}
+
+	// INDEXED BY x86::instruction::handler(), RESOLVED AT DECODE TIME
+	inline constexpr table_t table = []()
+	{
+		table_t table{};
+		table.fill(&vm::handler::unknown);
+
+		table[x86::dispatch::truncated] = &vm::handler::truncated;
+		table[x86::dispatch::add_byte] = &vm::handler::add::byte;
+		table[x86::dispatch::jump] = &vm::handler::branch::jump;
+		table[x86::dispatch::jump_conditional] = &vm::handler::branch::jump_conditional;
+		table[x86::dispatch::call] = &vm::handler::branch::call;
+		table[x86::dispatch::ret] = &vm::handler::branch::ret;
+		vm::handler::impl::fill_add(table, std::make_integer_sequence<std::uint16_t, x86::dispatch::variant::count>{});
+
+		return table;
+	}();
+}
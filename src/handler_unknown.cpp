@@ -1,8 +1,9 @@
 #include "handler_unknown.hpp"
+#include "virtual_machine.hpp"
+#include "compiler_helper.hpp"
 
-void vm::handler::unknown(x86::instruction& instr)
+vm::fault vm::handler::unknown(virtual_machine* vm, x86::instruction& instr)
 {
-	
 	printf("Size: [%02X] ", instr.size());
 
 	
@@ -20,12 +21,24 @@ void vm::handler::unknown(x86::instruction& instr)
 
 	
 	printf("Opcode: [");
-	for (const auto& opcode : instr.opcode().buffer())
+	for (const auto opcode : instr.opcode().buffer())
 		printf("%02X", opcode);
 	printf("] ");
 
 	printf("Operand: [");
-	for (const auto& operand : instr.operand().buffer())
+	for (const auto operand : instr.operand().buffer())
 		printf("%02X", operand);
 	printf("]");
+
+	// DECODE FAULTS REPORT THE INSTRUCTION ITSELF, THE INSTRUCTION POINTER ALREADY POINTS PAST IT
+	const auto address = vm->context().instruction_pointer() - instr.size();
+	return vm::fault{ vm::fault_code::invalid_opcode, address, nullptr };
+}
+
+vm::fault vm::handler::truncated(virtual_machine* vm, x86::instruction& instr)
+{
+	compiler::unreferenced_variable(instr);
+
+	// THE INSTRUCTION COVERS EVERY REMAINING BYTE, SO THE INSTRUCTION POINTER IS THE END OF THE CODE
+	return vm::fault{ vm::fault_code::page_fault, vm->context().instruction_pointer(), nullptr };
 }
@@ -3,7 +3,15 @@
 // X86
 #include "instruction.hpp"
 
+// VM
+#include "fault.hpp"
+
+class virtual_machine;
+
 namespace vm::handler
 {
-	void unknown(x86::instruction& instr);
+	vm::fault unknown(virtual_machine* vm, x86::instruction& instr);
+
+	// THE ENCODING RUNS PAST THE END OF THE CODE, FETCHING THE FIRST MISSING BYTE FAULTS
+	vm::fault truncated(virtual_machine* vm, x86::instruction& instr);
 }
\ No newline at end of file
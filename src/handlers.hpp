@@ -2,4 +2,5 @@
 
 // VM
 #include "handler_add.hpp"
+#include "handler_table.hpp"
 #include "handler_unknown.hpp"
\ No newline at end of file
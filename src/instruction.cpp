@@ -4,6 +4,7 @@
 #include "instruction_prefix.hpp"
 #include "instruction_operand.hpp"
 #include "instruction_modrm.hpp"
+#include "instruction_spec.hpp"
 
 bool& x86::instruction::opcode_initialised()
 {
@@ -32,7 +33,14 @@ std::uint8_t& x86::instruction::size()
 
 std::string x86::instruction::name()
 {
-	return x86::opcode::names.at(this->opcode().as<uint32_t>());
+	auto spec = &x86::spec::find(*this);
+	if (this->modrm().has_value())
+		spec = &x86::spec::extension(*spec, this->modrm().value().reg);
+
+	if (spec->name == nullptr)
+		throw std::exception("Unknown opcode");
+
+	return spec->name;
 }
 
 x86::opcode& x86::instruction::opcode()
@@ -55,9 +63,51 @@ std::optional<x86::rex>& x86::instruction::rex()
 	return this->m_rex;
 }
 
+std::optional<x86::vex>& x86::instruction::vex()
+{
+	return this->m_vex;
+}
+
+std::optional<x86::modrm>& x86::instruction::modrm()
+{
+	return this->m_modrm;
+}
+
+std::optional<x86::sib>& x86::instruction::sib()
+{
+	return this->m_sib;
+}
+
+std::int32_t& x86::instruction::displacement()
+{
+	return this->m_displacement;
+}
+
+std::uint8_t& x86::instruction::displacement_size()
+{
+	return this->m_displacement_size;
+}
+
+std::uint64_t& x86::instruction::immediate()
+{
+	return this->m_immediate;
+}
+
+std::uint8_t& x86::instruction::immediate_size()
+{
+	return this->m_immediate_size;
+}
+
+std::uint16_t& x86::instruction::handler()
+{
+	return this->m_handler;
+}
+
 x86::instruction::modifier_data_t x86::instruction::get_modifier(size_t index)
 {
-	auto modrm = this->operand().get<x86::modrm>(index);
+	auto modrm = index == 0 && this->modrm().has_value() ?
+		this->modrm().value() :
+		this->operand().get<x86::modrm>(index);
 
 	auto mode = modrm.mode;
 	auto destination_reg = modrm.reg;
@@ -65,7 +115,7 @@ x86::instruction::modifier_data_t x86::instruction::get_modifier(size_t index)
 	std::uint8_t wide = 0;
 
 	
-	if (this->rex().has_value() && this->rex().value().w == 1)
+	if (this->rex().has_value())
 	{
 		
 		auto extended_modrm = x86::modrm_e(modrm, this->rex().value());
@@ -76,4 +126,4 @@ x86::instruction::modifier_data_t x86::instruction::get_modifier(size_t index)
 	}
 
 	return x86::instruction::modifier_data_t{ mode, wide, source_reg, destination_reg };
-}
+}
\ No newline at end of file
@@ -3,18 +3,20 @@
 // STD
 #include <cstdint>
 #include <optional>
-#include <vector>
+#include <type_traits>
 
 // x86
 #include "instruction_opcode.hpp"
 #include "instruction_rex.hpp"
 #include "instruction_operand.hpp"
 #include "instruction_prefix.hpp"
+#include "instruction_modrm.hpp"
+#include "instruction_vex.hpp"
 
 namespace x86
 {
-	
-	class instruction
+	// DECODED INSTRUCTION, TRIVIALLY COPYABLE AND ONE CACHE LINE WIDE
+	class alignas(64) instruction
 	{
 	public:
 		
@@ -29,6 +31,18 @@ namespace x86
 		x86::operand& operand();			
 		x86::prefix& prefix();				
 		std::optional<x86::rex>& rex();		
+		std::optional<x86::vex>& vex();
+
+		// PRE-EXTRACTED OPERAND FIELDS
+		std::optional<x86::modrm>& modrm();
+		std::optional<x86::sib>& sib();
+		std::int32_t& displacement();		
+		std::uint8_t& displacement_size();
+		std::uint64_t& immediate();			
+		std::uint8_t& immediate_size();
+
+		// INDEX INTO THE VM HANDLER TABLE
+		std::uint16_t& handler();
 
 		
 		struct modifier_data_t
@@ -41,16 +55,28 @@ namespace x86
 		modifier_data_t get_modifier(size_t index);
 
 	private:
+		std::uint64_t m_immediate;
+		std::int32_t m_displacement;
+		std::uint16_t m_handler;
+
+		x86::prefix m_prefix;					// 0-4 BYTES
+		x86::opcode m_opcode;					// 1-3 BYTES
+		x86::operand m_operand;					// 0-14 BYTES
+		std::optional<x86::rex> m_rex;			// 0-1 BYTES
+		std::optional<x86::modrm> m_modrm;
+		std::optional<x86::sib> m_sib;
+		std::optional<x86::vex> m_vex;
+
+		std::uint8_t m_displacement_size;
+		std::uint8_t m_immediate_size;
+		std::uint8_t m_size;
+
 		bool m_opcode_init;
 		bool m_operand_init;
 		bool m_prefix_init;
 		bool m_rex_init;
-
-		std::uint8_t m_size;
-
-		x86::opcode m_opcode;					// 1-3 BYTES
-		x86::operand m_operand;					// 0-8 BYTES
-		x86::prefix m_prefix;					// 0-4 BYTES
-		std::optional<x86::rex> m_rex;			// 0-1 BYTES
 	};
+
+	static_assert(std::is_trivially_copyable_v<x86::instruction>, "x86::instruction must stay trivially copyable");
+	static_assert(sizeof(x86::instruction) == 64, "x86::instruction must fit a single cache line");
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+// STD
+#include <array>
+#include <cstdint>
+
+namespace x86
+{
+	// INLINE, FIXED-CAPACITY BYTE BUFFER
+	// KEEPS DECODED INSTRUCTIONS TRIVIALLY COPYABLE AND OFF THE HEAP
+	template <std::size_t N>
+	class fixed_buffer
+	{
+	public:
+		static_assert(N < 0xFF, "fixed_buffer size is stored in a single byte");
+
+
+		void append(std::uint8_t value)
+		{
+			if (this->m_size < N)
+				this->m_data[this->m_size++] = value;
+		}
+
+		std::uint8_t* data()
+		{
+			return this->m_data.data();
+		}
+
+		std::size_t size() const
+		{
+			return this->m_size;
+		}
+
+		static constexpr std::size_t capacity()
+		{
+			return N;
+		}
+
+		std::uint8_t at(std::size_t index) const
+		{
+			return this->m_data.at(index);
+		}
+
+
+		const std::uint8_t* begin() const
+		{
+			return this->m_data.data();
+		}
+
+		const std::uint8_t* end() const
+		{
+			return this->m_data.data() + this->m_size;
+		}
+
+	private:
+		std::array<std::uint8_t, N> m_data;
+		std::uint8_t m_size;
+	};
+}
@@ -1,106 +1,303 @@
 #include "instruction_cache.hpp"
 #include <algorithm>
+#include <bit>
 
 namespace vm
 {
-    instruction_cache& instruction_cache::get_instance()
+    void cache_counters::hit()
     {
-        static instruction_cache instance;
-        return instance;
+        m_slots[thread_slot()].hits.fetch_add(1, std::memory_order_relaxed);
     }
 
-    instruction_cache::instruction_cache()
-        : m_max_size(1024)
-        , m_hit_count(0)
-        , m_miss_count(0)
-    {}
-
-    std::shared_ptr<x86::instruction> instruction_cache::get(uint8_t* address)
+    void cache_counters::miss()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots[thread_slot()].misses.fetch_add(1, std::memory_order_relaxed);
+    }
 
-        auto it = m_cache.find(address);
-        if (it != m_cache.end())
+    void cache_counters::reset()
+    {
+        for (auto& slot : m_slots)
         {
-            it->second.last_access = ++m_hit_count;
-            it->second.access_count++;
-            return it->second.instruction;
+            slot.hits.store(0, std::memory_order_relaxed);
+            slot.misses.store(0, std::memory_order_relaxed);
         }
+    }
 
-        m_miss_count++;
-        return nullptr;
+    uint64_t cache_counters::hits() const
+    {
+        uint64_t total = 0;
+        for (const auto& slot : m_slots)
+            total += slot.hits.load(std::memory_order_relaxed);
+
+        return total;
     }
 
-    void instruction_cache::put(uint8_t* address, std::shared_ptr<x86::instruction> instruction)
+    uint64_t cache_counters::misses() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t total = 0;
+        for (const auto& slot : m_slots)
+            total += slot.misses.load(std::memory_order_relaxed);
 
-        if (m_cache.size() >= m_max_size)
-        {
-            evict_oldest();
-        }
+        return total;
+    }
+
+    size_t cache_counters::thread_slot()
+    {
+        static std::atomic<size_t> next_slot{ 0 };
+        thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % slot_count;
+        return slot;
+    }
 
-        cache_entry entry;
-        entry.instruction = instruction;
-        entry.last_access = ++m_hit_count;
-        entry.access_count = 1;
 
-        m_cache[address] = entry;
+    instruction_cache::instruction_cache(size_t capacity)
+        : m_capacity(std::max<size_t>(capacity, 1))
+        , m_size(0)
+        , m_hand(0)
+    {
+        // KEEP THE LOAD FACTOR AT OR BELOW 3/4 SO PROBE CHAINS STAY SHORT
+        const auto slot_count = std::bit_ceil(m_capacity + m_capacity / 3 + 1);
+
+        m_slots.assign(slot_count, slot{ nullptr, false });
+        m_instructions.resize(slot_count);
+        m_mask = slot_count - 1;
     }
 
-    void instruction_cache::clear()
+    uint64_t instruction_cache::hash(uint8_t* address)
+    {
+        // FIBONACCI HASHING, SEQUENTIAL ADDRESSES LAND FAR APART
+        return reinterpret_cast<uint64_t>(address) * 0x9E3779B97F4A7C15ull;
+    }
+
+    bool instruction_cache::get(uint8_t* address, x86::instruction& instruction)
+    {
+        const auto found = lookup(address, instruction);
+        if (found)
+            ++m_hits;
+        else
+            ++m_misses;
+
+        return found;
+    }
+
+    bool instruction_cache::lookup(uint8_t* address, x86::instruction& instruction)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_cache.clear();
-        m_hit_count = 0;
-        m_miss_count = 0;
+        const auto index = find(address);
+        if (index == m_slots.size())
+            return false;
+
+        m_slots[index].referenced = true;
+        instruction = m_instructions[index];
+
+        return true;
     }
 
-    void instruction_cache::set_max_size(size_t size)
+    void instruction_cache::put(uint8_t* address, const x86::instruction& instruction)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_max_size = size;
-        while (m_cache.size() > m_max_size)
+        auto index = find(address);
+        if (index == m_slots.size())
         {
-            evict_oldest();
+            if (m_size >= m_capacity)
+                evict();
+
+            index = (hash(address) >> 32) & m_mask;
+            while (m_slots[index].address != nullptr)
+                index = (index + 1) & m_mask;
+
+            m_slots[index].address = address;
+            ++m_size;
         }
+
+        m_slots[index].referenced = true;
+        m_instructions[index] = instruction;
+    }
+
+    bool instruction_cache::erase(uint8_t* address)
+    {
+        const auto index = find(address);
+        if (index == m_slots.size())
+            return false;
+
+        remove(index);
+        return true;
+    }
+
+    void instruction_cache::clear()
+    {
+        std::fill(m_slots.begin(), m_slots.end(), slot{ nullptr, false });
+        m_size = 0;
+        m_hand = 0;
+        m_hits = 0;
+        m_misses = 0;
     }
 
     size_t instruction_cache::get_size() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_cache.size();
+        return m_size;
+    }
+
+    size_t instruction_cache::get_capacity() const
+    {
+        return m_capacity;
     }
 
     size_t instruction_cache::get_hit_count() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_hit_count;
+        return m_hits;
     }
 
     size_t instruction_cache::get_miss_count() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_miss_count;
+        return m_misses;
     }
 
     float instruction_cache::get_hit_ratio() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        size_t total = m_hit_count + m_miss_count;
-        return total > 0 ? static_cast<float>(m_hit_count) / total : 0.0f;
+        const auto total = m_hits + m_misses;
+        return total > 0 ? static_cast<float>(m_hits) / total : 0.0f;
+    }
+
+    size_t instruction_cache::find(uint8_t* address) const
+    {
+        // LINEAR PROBING, AN EMPTY SLOT ENDS THE CHAIN
+        for (auto index = (hash(address) >> 32) & m_mask; m_slots[index].address != nullptr; index = (index + 1) & m_mask)
+        {
+            if (m_slots[index].address == address)
+                return index;
+        }
+
+        return m_slots.size();
+    }
+
+    void instruction_cache::evict()
+    {
+        // SECOND CHANCE: CLEAR REFERENCE BITS UNTIL AN UNREFERENCED ENTRY COMES UP
+        while (true)
+        {
+            auto& slot = m_slots[m_hand];
+
+            if (slot.address != nullptr)
+            {
+                if (!slot.referenced)
+                {
+                    remove(m_hand);
+                    return;
+                }
+
+                slot.referenced = false;
+            }
+
+            m_hand = (m_hand + 1) & m_mask;
+        }
+    }
+
+    void instruction_cache::remove(size_t index)
+    {
+        // BACKWARD-SHIFT DELETION, NO TOMBSTONES TO SLOW DOWN LATER PROBES
+        auto hole = index;
+        for (auto next = (hole + 1) & m_mask; m_slots[next].address != nullptr; next = (next + 1) & m_mask)
+        {
+            const auto home = (hash(m_slots[next].address) >> 32) & m_mask;
+
+            // ONLY MOVE ENTRIES WHOSE PROBE CHAIN PASSES THROUGH THE HOLE
+            if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+            {
+                m_slots[hole] = m_slots[next];
+                m_instructions[hole] = m_instructions[next];
+                hole = next;
+            }
+        }
+
+        m_slots[hole] = slot{ nullptr, false };
+        --m_size;
     }
 
-    void instruction_cache::evict_oldest()
+
+    sharded_instruction_cache::sharded_instruction_cache(size_t capacity, size_t shards)
     {
-        auto oldest = std::min_element(m_cache.begin(), m_cache.end(),
-            [](const auto& a, const auto& b) {
-                return a.second.last_access < b.second.last_access;
-            });
+        const auto count = std::bit_ceil(std::max<size_t>(shards, 1));
+        const auto per_shard = std::max<size_t>(capacity / count, 1);
+
+        for (size_t i = 0; i < count; i++)
+            m_shards.push_back(std::make_unique<shard>(per_shard));
+    }
 
-        if (oldest != m_cache.end())
+    sharded_instruction_cache::shard& sharded_instruction_cache::shard_for(uint8_t* address)
+    {
+        // LOW HASH BITS PICK THE SHARD, THE SHARD'S TABLE USES THE HIGH ONES
+        return *m_shards[instruction_cache::hash(address) & (m_shards.size() - 1)];
+    }
+
+    bool sharded_instruction_cache::get(uint8_t* address, x86::instruction& instruction)
+    {
+        auto& shard = shard_for(address);
+
+        bool found;
         {
-            m_cache.erase(oldest);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            found = shard.cache.lookup(address, instruction);
         }
+
+        if (found)
+            m_counters.hit();
+        else
+            m_counters.miss();
+
+        return found;
+    }
+
+    void sharded_instruction_cache::put(uint8_t* address, const x86::instruction& instruction)
+    {
+        auto& shard = shard_for(address);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.put(address, instruction);
+    }
+
+    bool sharded_instruction_cache::erase(uint8_t* address)
+    {
+        auto& shard = shard_for(address);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.erase(address);
+    }
+
+    void sharded_instruction_cache::clear()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->cache.clear();
+        }
+
+        m_counters.reset();
+    }
+
+    size_t sharded_instruction_cache::get_size() const
+    {
+        size_t size = 0;
+        for (const auto& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            size += shard->cache.get_size();
+        }
+
+        return size;
+    }
+
+    size_t sharded_instruction_cache::get_hit_count() const
+    {
+        return m_counters.hits();
+    }
+
+    size_t sharded_instruction_cache::get_miss_count() const
+    {
+        return m_counters.misses();
+    }
+
+    float sharded_instruction_cache::get_hit_ratio() const
+    {
+        const auto hits = m_counters.hits();
+        const auto total = hits + m_counters.misses();
+        return total > 0 ? static_cast<float>(hits) / total : 0.0f;
     }
-} 
\ No newline at end of file
+} 
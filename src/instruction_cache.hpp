@@ -1,45 +1,122 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
-#include <unordered_map>
-#include <vector>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "instruction.hpp"
 
 namespace vm
 {
+    // HIT/MISS COUNTERS SPREAD OVER CACHE-LINE-SIZED SLOTS, ONE PER THREAD, SUMMED ON READ
+    class cache_counters
+    {
+    public:
+        void hit();
+        void miss();
+        void reset();
+
+        uint64_t hits() const;
+        uint64_t misses() const;
+
+    private:
+        static constexpr size_t slot_count = 64;
+
+        struct alignas(64) slot
+        {
+            std::atomic<uint64_t> hits{ 0 };
+            std::atomic<uint64_t> misses{ 0 };
+        };
+
+        static size_t thread_slot();
+
+        std::array<slot, slot_count> m_slots;
+    };
+
+    // OPEN-ADDRESSED CACHE OF DECODED INSTRUCTIONS KEYED BY GUEST ADDRESS, NOT THREAD SAFE.
+    // INSTRUCTIONS ARE STORED INLINE, A FULL CACHE EVICTS IN AMORTISED O(1) WITH CLOCK
     class instruction_cache
     {
     public:
-        struct cache_entry
+        static constexpr size_t default_capacity = 1024;
+
+        explicit instruction_cache(size_t capacity = default_capacity);
+
+        bool get(uint8_t* address, x86::instruction& instruction);
+        void put(uint8_t* address, const x86::instruction& instruction);
+        bool erase(uint8_t* address);
+        void clear();
+
+        // GET WITHOUT TOUCHING THE HIT/MISS COUNTS, FOR OWNERS THAT KEEP THEIR OWN
+        bool lookup(uint8_t* address, x86::instruction& instruction);
+
+        size_t get_size() const;
+        size_t get_capacity() const;
+        size_t get_hit_count() const;
+        size_t get_miss_count() const;
+        float get_hit_ratio() const;
+
+        static uint64_t hash(uint8_t* address);
+
+    private:
+        struct slot
         {
-            std::shared_ptr<x86::instruction> instruction;
-            uint64_t last_access;
-            uint64_t access_count;
+            uint8_t* address;
+            bool referenced;
         };
 
-        static instruction_cache& get_instance();
+        size_t find(uint8_t* address) const;
+        void evict();
+        void remove(size_t index);
+
+        // KEYS AND REFERENCE BITS ARE PROBED, INSTRUCTIONS ARE ONLY TOUCHED ON A HIT
+        std::vector<slot> m_slots;
+        std::vector<x86::instruction> m_instructions;
+
+        size_t m_mask;
+        size_t m_capacity;
+        size_t m_size;
+        size_t m_hand;
+
+        // SINGLE OWNER, PLAIN COUNTERS ARE ENOUGH
+        size_t m_hits = 0;
+        size_t m_misses = 0;
+    };
 
-        std::shared_ptr<x86::instruction> get(uint8_t* address);
-        void put(uint8_t* address, std::shared_ptr<x86::instruction> instruction);
+    // INSTRUCTION CACHE SHARED BETWEEN THREADS, SPLIT INTO INDEPENDENTLY LOCKED SHARDS BY ADDRESS HASH
+    class sharded_instruction_cache
+    {
+    public:
+        static constexpr size_t default_shards = 16;
+
+        explicit sharded_instruction_cache(size_t capacity = instruction_cache::default_capacity * default_shards, size_t shards = default_shards);
+
+        bool get(uint8_t* address, x86::instruction& instruction);
+        void put(uint8_t* address, const x86::instruction& instruction);
+        bool erase(uint8_t* address);
         void clear();
-        void set_max_size(size_t size);
+
         size_t get_size() const;
         size_t get_hit_count() const;
         size_t get_miss_count() const;
         float get_hit_ratio() const;
 
     private:
-        instruction_cache();
-        ~instruction_cache() = default;
+        struct alignas(64) shard
+        {
+            explicit shard(size_t capacity) : cache(capacity) {}
+
+            mutable std::mutex mutex;
+            vm::instruction_cache cache;
+        };
+
+        shard& shard_for(uint8_t* address);
 
-        std::unordered_map<uint8_t*, cache_entry> m_cache;
-        size_t m_max_size;
-        size_t m_hit_count;
-        size_t m_miss_count;
-        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<shard>> m_shards;
 
-        void evict_oldest();
+        // COUNTED OUTSIDE THE SHARD LOCKS, THE SHARDS' OWN COUNTERS ARE NEVER TOUCHED
+        vm::cache_counters m_counters;
     };
-} 
\ No newline at end of file
+} 
@@ -0,0 +1,32 @@
+// x86
+#include "instruction_dispatch.hpp"
+#include "instruction_spec.hpp"
+
+std::uint16_t x86::dispatch::resolve(x86::instruction& instr)
+{
+	const auto* spec = &x86::spec::find(instr);
+
+
+	if (spec->group != x86::spec::group_none)
+	{
+		if (!instr.modrm().has_value())
+			return x86::dispatch::unknown;
+
+		spec = &x86::spec::extension(*spec, instr.modrm().value().reg);
+	}
+
+
+	if (!spec->specialised)
+		return spec->handler;
+
+	if (!instr.modrm().has_value())
+		return x86::dispatch::unknown;
+
+
+	const auto variant = x86::dispatch::variant::index(
+		x86::spec::operand_size(x86::spec::find(instr), instr),
+		x86::spec::address_size(instr),
+		instr.modrm().value().mode);
+
+	return static_cast<std::uint16_t>(spec->handler + variant);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// STD
+#include <cstdint>
+
+// x86
+#include "instruction.hpp"
+
+// SPECIALISED HANDLERS GET ONE ID PER OPERAND SIZE (16/32/64), ADDRESS SIZE (32/64) AND MODRM MODE
+// ORDER MUST MATCH x86::dispatch::variant::index
+#define X64VM_HANDLER_MODES(X, name)				\
+	X(name##_0) X(name##_1) X(name##_2) X(name##_3)
+
+#define X64VM_HANDLER_ADDRESS_SIZES(X, name)		\
+	X64VM_HANDLER_MODES(X, name##_a32)				\
+	X64VM_HANDLER_MODES(X, name##_a64)
+
+#define X64VM_HANDLER_VARIANTS(X, name)				\
+	X64VM_HANDLER_ADDRESS_SIZES(X, name##_o16)		\
+	X64VM_HANDLER_ADDRESS_SIZES(X, name##_o32)		\
+	X64VM_HANDLER_ADDRESS_SIZES(X, name##_o64)
+
+// EVERY HANDLER THE VM CAN DISPATCH TO, IN TABLE ORDER
+// X-MACRO SO THE ID ENUM AND THE THREADED DISPATCH LABELS CANNOT DRIFT APART
+#define X64VM_HANDLER_IDS(X)										\
+	X(unknown)														\
+	X(truncated)													\
+	X(add_byte)														\
+	X(jump)															\
+	X(jump_conditional)												\
+	X(call)															\
+	X(ret)															\
+	X64VM_HANDLER_VARIANTS(X, add_displaced_source)					\
+	X64VM_HANDLER_VARIANTS(X, add_displaced_destination)
+
+namespace x86::dispatch
+{
+	enum id : std::uint16_t
+	{
+#define X64VM_HANDLER_ID(name) name,
+		X64VM_HANDLER_IDS(X64VM_HANDLER_ID)
+#undef X64VM_HANDLER_ID
+		END_OF_HANDLER,
+
+		// FIRST VARIANT OF EACH SPECIALISED FAMILY
+		add_displaced_source = add_displaced_source_o16_a32_0,
+		add_displaced_destination = add_displaced_destination_o16_a32_0,
+	};
+
+	namespace variant
+	{
+		constexpr std::uint16_t count = 3 * 2 * 4;
+
+		constexpr std::uint16_t index(std::uint8_t operand_size, std::uint8_t address_size, std::uint8_t mode)
+		{
+			const std::uint16_t operand_index = operand_size == 8 ? 2 : operand_size == 4 ? 1 : 0;
+			const std::uint16_t address_index = address_size == 8 ? 1 : 0;
+			return static_cast<std::uint16_t>((operand_index * 2 + address_index) * 4 + mode);
+		}
+
+		constexpr std::uint8_t operand_size(std::uint16_t index)
+		{
+			constexpr std::uint8_t sizes[] = { 2, 4, 8 };
+			return sizes[index / 8];
+		}
+
+		constexpr std::uint8_t address_size(std::uint16_t index)
+		{
+			return (index / 4) % 2 == 0 ? 4 : 8;
+		}
+
+		constexpr std::uint8_t mode(std::uint16_t index)
+		{
+			return index % 4;
+		}
+	}
+
+	// CONTROL TRANSFERS TERMINATE A BASIC BLOCK
+	constexpr bool ends_block(std::uint16_t handler)
+	{
+		return handler == x86::dispatch::jump || handler == x86::dispatch::jump_conditional ||
+			handler == x86::dispatch::call || handler == x86::dispatch::ret;
+	}
+
+	// RESOLVE THE HANDLER OF A FULLY DECODED INSTRUCTION
+	std::uint16_t resolve(x86::instruction& instr);
+}
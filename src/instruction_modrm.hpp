@@ -13,10 +13,11 @@ namespace x86
 		std::uint8_t mode : 2;	
 
 		
-		// MODE 0: [REG]
+		// MODE 0: [REG], [RIP]+disp32 FOR RM 101
 		// MODE 1: [REG]+disp8
 		// MODE 2: [REG]+disp32
 		// MODE 3: REG
+		// RM 100 WITH MODE != 3 IS FOLLOWED BY A SIB BYTE
 
 		
 		std::uint8_t data_size()
@@ -34,11 +35,26 @@ namespace x86
 				return 4;
 			}
 			
+			case 0:
+			{
+				return this->rip_relative() ? 4 : 0;
+			}
+
 			default:
 				return 0;
 			}
 		}
 
+		bool has_sib() const
+		{
+			return this->mode != 3 && this->rm == 4;
+		}
+
+		bool rip_relative() const
+		{
+			return this->mode == 0 && this->rm == 5;
+		}
+
 		
 		std::string mode_to_string()
 		{
@@ -56,6 +72,20 @@ namespace x86
 		}
 	};
 
+	// SCALED INDEX BYTE, FOLLOWS MODRM WHEN MODE != 3 AND RM == 100
+	struct sib
+	{
+		std::uint8_t base : 3;
+		std::uint8_t index : 3;
+		std::uint8_t scale : 2;
+
+		// BASE 101 WITH MODRM MODE 0 MEANS NO BASE, DISP32 INSTEAD
+		bool has_base(std::uint8_t mode) const
+		{
+			return !(mode == 0 && this->base == 5);
+		}
+	};
+
 	
 	struct modrm_e
 	{
@@ -2,8 +2,9 @@
 
 // STD
 #include <cstdint>
-#include <map>
-#include <vector>
+
+// x86
+#include "instruction_buffer.hpp"
 
 
 namespace x86
@@ -11,18 +12,22 @@ namespace x86
 	class opcode
 	{
 	public:
-		
-		opcode(std::vector<std::uint8_t> opcode) : m_opcode(opcode) {}
+		// OPCODES ARE AT MOST 3 BYTES
+		using buffer_t = x86::fixed_buffer<3>;
 
 		
 		template <class T, size_t N>
-		opcode(T(&opcode)[N]) : m_opcode(opcode) {}
+		opcode(T(&opcode)[N]) : m_opcode()
+		{
+			for (const auto byte : opcode)
+				this->m_opcode.append(static_cast<std::uint8_t>(byte));
+		}
 
 		
-		opcode() : m_opcode() {}
+		opcode() = default;
 
 		
-		std::vector<std::uint8_t>& buffer();
+		buffer_t& buffer();
 
 		
 		template <class T>
@@ -71,13 +76,9 @@ namespace x86
 		// MOV
 #pragma endregion
 
-		
-		using name_map_t = std::map<std::uint32_t, std::string>;
-		const static name_map_t names;
-
 	private:
 		
-		std::vector<std::uint8_t> m_opcode;
+		buffer_t m_opcode;
 
 	};
 }
\ No newline at end of file
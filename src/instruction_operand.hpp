@@ -1,11 +1,10 @@
 #pragma once
 
 // STD
-#include <map>
-#include <vector>
 #include <tuple>
 
 // x86
+#include "instruction_buffer.hpp"
 #include "instruction_opcode.hpp"
 
 namespace x86
@@ -13,18 +12,22 @@ namespace x86
 	class operand
 	{
 public:
-		
-		operand(std::vector<std::uint8_t> operand) : m_operand(operand) {}
+		// MODRM + SIB + DISP32 + IMM32, OR A LONE IMM64
+		using buffer_t = x86::fixed_buffer<14>;
 
 		
 		template <class T, size_t N>
-		operand(T(&operand)[N]) : m_operand(operand) {}
+		operand(T(&operand)[N]) : m_operand()
+		{
+			for (const auto byte : operand)
+				this->m_operand.append(static_cast<std::uint8_t>(byte));
+		}
 
 		
-		operand() : m_operand() {}
+		operand() = default;
 
 		
-		std::vector<std::uint8_t>& buffer();
+		buffer_t& buffer();
 
 		
 		template <typename T>
@@ -55,18 +58,7 @@ public:
 			return std::make_tuple(get_dynamic<T>(index)...);
 		}
 
-		struct operand_info
-		{
-			//operand_info(bool new_modrm, std::uint8_t new_size) : modrm(new_modrm), size(new_size) {}
-			bool modrm;
-			std::uint8_t size;
-		};
-
-		
-		using operand_map_t = std::map<std::uint32_t, x86::operand::operand_info>;
-		const static operand_map_t info;
-
 	private:
-		std::vector<std::uint8_t> m_operand;
+		buffer_t m_operand;
 	};
 }
\ No newline at end of file
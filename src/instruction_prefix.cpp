@@ -20,38 +20,36 @@ const x86::prefix::prefix_list_t x86::prefix::list = {
 
 bool x86::prefix::has(std::uint8_t prefix)
 {
-	return std::any_of(
-		this->buffer().begin(), this->buffer().end(),
-		[prefix](std::uint8_t iter_prefix) { 
-			return iter_prefix == prefix; 
-		});
+	return (this->m_mask & x86::prefix::bit(prefix)) != 0;
 }
 
 bool x86::prefix::is(std::uint8_t prefix)
 {
-	return std::any_of(
-		x86::prefix::list.begin(), x86::prefix::list.end(),
-		[prefix](std::uint8_t iter_prefix) {
-		return iter_prefix == prefix;
-	});
+	return x86::prefix::bit(prefix) != 0;
 }
 
 void x86::prefix::append(std::uint8_t prefix)
 {
-	this->buffer().emplace_back(prefix);
+	this->m_mask |= x86::prefix::bit(prefix);
+	this->buffer().append(prefix);
 }
-;
-x86::prefix::vector_iter_t x86::prefix::begin()
+
+std::uint16_t x86::prefix::mask()
+{
+	return this->m_mask;
+}
+
+x86::prefix::iter_t x86::prefix::begin()
 {
 	return this->buffer().begin();
 }
 
-x86::prefix::vector_iter_t x86::prefix::end()
+x86::prefix::iter_t x86::prefix::end()
 {
 	return this->buffer().end();
 }
 
-std::vector<std::uint8_t>& x86::prefix::buffer()
+x86::fixed_buffer<4>& x86::prefix::buffer()
 {
 	return this->m_buffer;
 }
@@ -2,14 +2,17 @@
 
 // STD
 #include <array>
-#include <vector>
+#include <cstdint>
+
+// x86
+#include "instruction_buffer.hpp"
 
 namespace x86
 {
 	class prefix
 	{
 	public:
-		prefix() : m_buffer() {}
+		prefix() = default;
 
 		
 		bool has(std::uint8_t prefix);
@@ -18,13 +21,36 @@ namespace x86
 		void append(std::uint8_t prefix);
 
 		
-		using vector_iter_t = std::vector<std::uint8_t>::const_iterator;
-		vector_iter_t begin();
-		vector_iter_t end();
+		using iter_t = const std::uint8_t*;
+		iter_t begin();
+		iter_t end();
 
 		
 		static bool is(std::uint8_t prefix);
 
+		// ONE BIT PER DISTINCT PREFIX BYTE, ZERO FOR NON-PREFIXES
+		static constexpr std::uint16_t bit(std::uint8_t prefix)
+		{
+			switch (prefix)
+			{
+			case x86::prefix::id::LOCK:						return 1 << 0;
+			case x86::prefix::id::REPNE:					return 1 << 1;
+			case x86::prefix::id::REP:						return 1 << 2;
+			case x86::prefix::id::CS_OVERRIDE:				return 1 << 3;
+			case x86::prefix::id::SS_OVERRIDE:				return 1 << 4;
+			case x86::prefix::id::DS_OVERRIDE:				return 1 << 5;
+			case x86::prefix::id::ES_OVERRIDE:				return 1 << 6;
+			case x86::prefix::id::FS_OVERRIDE:				return 1 << 7;
+			case x86::prefix::id::GS_OVERRIDE:				return 1 << 8;
+			case x86::prefix::id::OPERAND_SIZE_OVERRIDE:	return 1 << 9;
+			case x86::prefix::id::ADDRESS_SIZE_OVERRIDE:	return 1 << 10;
+			default:										return 0;
+			}
+		}
+
+		
+		std::uint16_t mask();
+
 		
 		using prefix_list_t = std::array<std::uint8_t, 14>;
 		static const prefix_list_t list;
@@ -58,13 +84,15 @@ namespace x86
 
 	private:
 		// ACCESSORS
-		std::vector<std::uint8_t>& buffer();
+		x86::fixed_buffer<4>& buffer();
 
 		// PRIVATE MEMBERS
 
-		// PREFIX BUFFER
-		// MAYBE USE BITMAP?
-		std::vector<std::uint8_t> m_buffer;
+		// PREFIX BITMAP, SEE x86::prefix::bit
+		std::uint16_t m_mask;
+
+		// RAW PREFIX BYTES IN ENCODING ORDER, KEPT FOR DISPLAY
+		x86::fixed_buffer<4> m_buffer;
 	};
 
 	
@@ -0,0 +1,518 @@
+#pragma once
+
+// STD
+#include <array>
+#include <cstdint>
+
+// x86
+#include "instruction.hpp"
+#include "instruction_dispatch.hpp"
+
+// SINGLE SOURCE OF OPCODE METADATA, EXPANDED AT COMPILE TIME INTO ONE DENSE ARRAY PER OPCODE MAP
+namespace x86::spec
+{
+	enum class map : std::uint8_t
+	{
+		one_byte,
+		two_byte,			// 0F XX
+		three_byte_38,		// 0F 38 XX
+		three_byte_3a,		// 0F 3A XX
+		group,				// OPCODE EXTENSIONS SELECTED BY MODRM.REG
+		END_OF_MAP
+	};
+
+	enum class immediate : std::uint8_t
+	{
+		none,
+		byte,				// IB
+		word,				// IW
+		full,				// IZ: 16 OR 32 BITS, NEVER 64
+		variable,			// IV: 16, 32 OR 64 BITS
+		word_byte,			// IW + IB, ENTER
+		offset				// MOFFS: ADDRESS SIZED
+	};
+
+	enum class operand : std::uint8_t
+	{
+		none,
+		byte,
+		full,				// 32 BITS, 66 SELECTS 16, REX.W SELECTS 64
+		default_64,			// 64 BITS, 66 SELECTS 16 (PUSH, POP)
+		force_64			// 64 BITS REGARDLESS OF 66 (NEAR BRANCHES)
+	};
+
+	enum group : std::uint8_t
+	{
+		group_none,
+		group_1_byte,			// 80
+		group_1,				// 81
+		group_1_sign_extended,	// 83
+		group_1a,				// 8F
+		group_2,				// C0, C1, D0-D3
+		group_3_byte,			// F6
+		group_3,				// F7
+		group_4,				// FE
+		group_5,				// FF
+		group_11,				// C6, C7
+		END_OF_GROUP
+	};
+
+
+	struct opcode_spec
+	{
+		// MNEMONIC, NULLPTR FOR UNDEFINED OPCODES
+		const char* name;
+
+		std::uint16_t handler;
+
+		// NON-ZERO FOR GROUP OPCODES, WHICH SELECT THEIR HANDLER BY MODRM.REG
+		std::uint8_t group;
+
+		// HANDLER IS THE FIRST OF x86::dispatch::variant::count SPECIALISATIONS
+		bool specialised;
+
+		bool valid;
+		bool modrm;
+		x86::spec::immediate immediate;
+		x86::spec::operand operand;
+	};
+
+	constexpr x86::spec::opcode_spec entry(
+		const char* name,
+		bool modrm,
+		x86::spec::immediate immediate,
+		x86::spec::operand operand,
+		std::uint16_t handler = x86::dispatch::unknown,
+		std::uint8_t group = group_none,
+		bool specialised = false)
+	{
+		return { name, handler, group, specialised, true, modrm, immediate, operand };
+	}
+
+	constexpr std::uint16_t slot(x86::spec::group group, std::uint8_t reg)
+	{
+		return static_cast<std::uint16_t>(group * 8 + reg);
+	}
+
+
+	struct row
+	{
+		x86::spec::map map;
+		std::uint16_t first;
+		std::uint16_t last;
+		x86::spec::opcode_spec spec;
+	};
+
+	// 64-BIT MODE, OPCODES LEFT OUT ARE INVALID. LATER ROWS OVERRIDE EARLIER ONES
+	inline constexpr x86::spec::row rows[] =
+	{
+		// ONE-BYTE MAP
+		{ map::one_byte,	0x00, 0x00,	entry("ADD", true, immediate::none, operand::byte, x86::dispatch::add_byte) },
+		{ map::one_byte,	0x01, 0x01,	entry("ADD", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x02, 0x02,	entry("ADD", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x03, 0x03,	entry("ADD", true, immediate::none, operand::full, x86::dispatch::add_displaced_source, group_none, true) },
+		{ map::one_byte,	0x04, 0x04,	entry("ADD", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x05, 0x05,	entry("ADD", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x08, 0x08,	entry("OR", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x09, 0x09,	entry("OR", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x0A, 0x0A,	entry("OR", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x0B, 0x0B,	entry("OR", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x0C, 0x0C,	entry("OR", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x0D, 0x0D,	entry("OR", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x10, 0x10,	entry("ADC", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x11, 0x11,	entry("ADC", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x12, 0x12,	entry("ADC", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x13, 0x13,	entry("ADC", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x14, 0x14,	entry("ADC", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x15, 0x15,	entry("ADC", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x18, 0x18,	entry("SBB", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x19, 0x19,	entry("SBB", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x1A, 0x1A,	entry("SBB", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x1B, 0x1B,	entry("SBB", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x1C, 0x1C,	entry("SBB", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x1D, 0x1D,	entry("SBB", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x20, 0x20,	entry("AND", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x21, 0x21,	entry("AND", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x22, 0x22,	entry("AND", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x23, 0x23,	entry("AND", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x24, 0x24,	entry("AND", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x25, 0x25,	entry("AND", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x28, 0x28,	entry("SUB", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x29, 0x29,	entry("SUB", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x2A, 0x2A,	entry("SUB", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x2B, 0x2B,	entry("SUB", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x2C, 0x2C,	entry("SUB", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x2D, 0x2D,	entry("SUB", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x30, 0x30,	entry("XOR", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x31, 0x31,	entry("XOR", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x32, 0x32,	entry("XOR", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x33, 0x33,	entry("XOR", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x34, 0x34,	entry("XOR", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x35, 0x35,	entry("XOR", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x38, 0x38,	entry("CMP", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x39, 0x39,	entry("CMP", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x3A, 0x3A,	entry("CMP", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x3B, 0x3B,	entry("CMP", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x3C, 0x3C,	entry("CMP", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0x3D, 0x3D,	entry("CMP", false, immediate::full, operand::full) },
+		{ map::one_byte,	0x50, 0x57,	entry("PUSH", false, immediate::none, operand::default_64) },
+		{ map::one_byte,	0x58, 0x5F,	entry("POP", false, immediate::none, operand::default_64) },
+		{ map::one_byte,	0x63, 0x63,	entry("MOVSXD", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x68, 0x68,	entry("PUSH", false, immediate::full, operand::default_64) },
+		{ map::one_byte,	0x69, 0x69,	entry("IMUL", true, immediate::full, operand::full) },
+		{ map::one_byte,	0x6A, 0x6A,	entry("PUSH", false, immediate::byte, operand::default_64) },
+		{ map::one_byte,	0x6B, 0x6B,	entry("IMUL", true, immediate::byte, operand::full) },
+		{ map::one_byte,	0x6C, 0x6D,	entry("INS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0x6E, 0x6F,	entry("OUTS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0x70, 0x7F,	entry("JCC", false, immediate::byte, operand::force_64, x86::dispatch::jump_conditional) },
+		{ map::one_byte,	0x80, 0x80,	entry("GRP1", true, immediate::byte, operand::byte, x86::dispatch::unknown, group_1_byte) },
+		{ map::one_byte,	0x81, 0x81,	entry("GRP1", true, immediate::full, operand::full, x86::dispatch::unknown, group_1) },
+		{ map::one_byte,	0x83, 0x83,	entry("GRP1", true, immediate::byte, operand::full, x86::dispatch::unknown, group_1_sign_extended) },
+		{ map::one_byte,	0x84, 0x84,	entry("TEST", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x85, 0x85,	entry("TEST", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x86, 0x86,	entry("XCHG", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x87, 0x87,	entry("XCHG", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x88, 0x88,	entry("MOV", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x89, 0x89,	entry("MOV", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x8A, 0x8A,	entry("MOV", true, immediate::none, operand::byte) },
+		{ map::one_byte,	0x8B, 0x8C,	entry("MOV", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x8D, 0x8D,	entry("LEA", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x8E, 0x8E,	entry("MOV", true, immediate::none, operand::full) },
+		{ map::one_byte,	0x8F, 0x8F,	entry("GRP1A", true, immediate::none, operand::default_64, x86::dispatch::unknown, group_1a) },
+		{ map::one_byte,	0x90, 0x97,	entry("XCHG", false, immediate::none, operand::full) },
+		{ map::one_byte,	0x98, 0x98,	entry("CDQE", false, immediate::none, operand::full) },
+		{ map::one_byte,	0x99, 0x99,	entry("CQO", false, immediate::none, operand::full) },
+		{ map::one_byte,	0x9B, 0x9B,	entry("FWAIT", false, immediate::none, operand::none) },
+		{ map::one_byte,	0x9C, 0x9C,	entry("PUSHF", false, immediate::none, operand::default_64) },
+		{ map::one_byte,	0x9D, 0x9D,	entry("POPF", false, immediate::none, operand::default_64) },
+		{ map::one_byte,	0x9E, 0x9E,	entry("SAHF", false, immediate::none, operand::none) },
+		{ map::one_byte,	0x9F, 0x9F,	entry("LAHF", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xA0, 0xA0,	entry("MOV", false, immediate::offset, operand::byte) },
+		{ map::one_byte,	0xA1, 0xA1,	entry("MOV", false, immediate::offset, operand::full) },
+		{ map::one_byte,	0xA2, 0xA2,	entry("MOV", false, immediate::offset, operand::byte) },
+		{ map::one_byte,	0xA3, 0xA3,	entry("MOV", false, immediate::offset, operand::full) },
+		{ map::one_byte,	0xA4, 0xA5,	entry("MOVS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xA6, 0xA7,	entry("CMPS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xA8, 0xA8,	entry("TEST", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0xA9, 0xA9,	entry("TEST", false, immediate::full, operand::full) },
+		{ map::one_byte,	0xAA, 0xAB,	entry("STOS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xAC, 0xAD,	entry("LODS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xAE, 0xAF,	entry("SCAS", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xB0, 0xB7,	entry("MOV", false, immediate::byte, operand::byte) },
+		{ map::one_byte,	0xB8, 0xBF,	entry("MOV", false, immediate::variable, operand::full) },
+		{ map::one_byte,	0xC0, 0xC0,	entry("GRP2", true, immediate::byte, operand::byte, x86::dispatch::unknown, group_2) },
+		{ map::one_byte,	0xC1, 0xC1,	entry("GRP2", true, immediate::byte, operand::full, x86::dispatch::unknown, group_2) },
+		{ map::one_byte,	0xC2, 0xC2,	entry("RET", false, immediate::word, operand::force_64, x86::dispatch::ret) },
+		{ map::one_byte,	0xC3, 0xC3,	entry("RET", false, immediate::none, operand::force_64, x86::dispatch::ret) },
+		{ map::one_byte,	0xC6, 0xC6,	entry("GRP11", true, immediate::byte, operand::byte, x86::dispatch::unknown, group_11) },
+		{ map::one_byte,	0xC7, 0xC7,	entry("GRP11", true, immediate::full, operand::full, x86::dispatch::unknown, group_11) },
+		{ map::one_byte,	0xC8, 0xC8,	entry("ENTER", false, immediate::word_byte, operand::default_64) },
+		{ map::one_byte,	0xC9, 0xC9,	entry("LEAVE", false, immediate::none, operand::default_64) },
+		{ map::one_byte,	0xCA, 0xCA,	entry("RETF", false, immediate::word, operand::full) },
+		{ map::one_byte,	0xCB, 0xCB,	entry("RETF", false, immediate::none, operand::full) },
+		{ map::one_byte,	0xCC, 0xCC,	entry("INT3", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xCD, 0xCD,	entry("INT", false, immediate::byte, operand::none) },
+		{ map::one_byte,	0xCF, 0xCF,	entry("IRET", false, immediate::none, operand::full) },
+		{ map::one_byte,	0xD0, 0xD0,	entry("GRP2", true, immediate::none, operand::byte, x86::dispatch::unknown, group_2) },
+		{ map::one_byte,	0xD1, 0xD1,	entry("GRP2", true, immediate::none, operand::full, x86::dispatch::unknown, group_2) },
+		{ map::one_byte,	0xD2, 0xD2,	entry("GRP2", true, immediate::none, operand::byte, x86::dispatch::unknown, group_2) },
+		{ map::one_byte,	0xD3, 0xD3,	entry("GRP2", true, immediate::none, operand::full, x86::dispatch::unknown, group_2) },
+		{ map::one_byte,	0xD7, 0xD7,	entry("XLAT", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xD8, 0xDF,	entry("FPU", true, immediate::none, operand::none) },
+		{ map::one_byte,	0xE0, 0xE0,	entry("LOOPNE", false, immediate::byte, operand::force_64) },
+		{ map::one_byte,	0xE1, 0xE1,	entry("LOOPE", false, immediate::byte, operand::force_64) },
+		{ map::one_byte,	0xE2, 0xE2,	entry("LOOP", false, immediate::byte, operand::force_64) },
+		{ map::one_byte,	0xE3, 0xE3,	entry("JRCXZ", false, immediate::byte, operand::force_64) },
+		{ map::one_byte,	0xE4, 0xE5,	entry("IN", false, immediate::byte, operand::none) },
+		{ map::one_byte,	0xE6, 0xE7,	entry("OUT", false, immediate::byte, operand::none) },
+		{ map::one_byte,	0xE8, 0xE8,	entry("CALL", false, immediate::full, operand::force_64, x86::dispatch::call) },
+		{ map::one_byte,	0xE9, 0xE9,	entry("JMP", false, immediate::full, operand::force_64, x86::dispatch::jump) },
+		{ map::one_byte,	0xEB, 0xEB,	entry("JMP", false, immediate::byte, operand::force_64, x86::dispatch::jump) },
+		{ map::one_byte,	0xEC, 0xED,	entry("IN", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xEE, 0xEF,	entry("OUT", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xF1, 0xF1,	entry("INT1", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xF4, 0xF4,	entry("HLT", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xF5, 0xF5,	entry("CMC", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xF6, 0xF6,	entry("GRP3", true, immediate::none, operand::byte, x86::dispatch::unknown, group_3_byte) },
+		{ map::one_byte,	0xF7, 0xF7,	entry("GRP3", true, immediate::none, operand::full, x86::dispatch::unknown, group_3) },
+		{ map::one_byte,	0xF8, 0xF8,	entry("CLC", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xF9, 0xF9,	entry("STC", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xFA, 0xFA,	entry("CLI", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xFB, 0xFB,	entry("STI", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xFC, 0xFC,	entry("CLD", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xFD, 0xFD,	entry("STD", false, immediate::none, operand::none) },
+		{ map::one_byte,	0xFE, 0xFE,	entry("GRP4", true, immediate::none, operand::byte, x86::dispatch::unknown, group_4) },
+		{ map::one_byte,	0xFF, 0xFF,	entry("GRP5", true, immediate::none, operand::full, x86::dispatch::unknown, group_5) },
+
+		// 0F XX
+		{ map::two_byte,	0x00, 0x00,	entry("GRP6", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x01, 0x01,	entry("GRP7", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x02, 0x02,	entry("LAR", true, immediate::none, operand::full) },
+		{ map::two_byte,	0x03, 0x03,	entry("LSL", true, immediate::none, operand::full) },
+		{ map::two_byte,	0x05, 0x05,	entry("SYSCALL", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x06, 0x06,	entry("CLTS", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x07, 0x07,	entry("SYSRET", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x08, 0x08,	entry("INVD", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x09, 0x09,	entry("WBINVD", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x0B, 0x0B,	entry("UD2", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x0D, 0x0D,	entry("PREFETCH", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x0F, 0x0F,	entry("3DNOW", true, immediate::byte, operand::none) },
+		{ map::two_byte,	0x10, 0x17,	entry("SSE", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x18, 0x1F,	entry("NOP", true, immediate::none, operand::full) },
+		{ map::two_byte,	0x20, 0x23,	entry("MOV", true, immediate::none, operand::force_64) },
+		{ map::two_byte,	0x28, 0x2F,	entry("SSE", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x30, 0x30,	entry("WRMSR", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x31, 0x31,	entry("RDTSC", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x32, 0x32,	entry("RDMSR", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x33, 0x33,	entry("RDPMC", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x34, 0x34,	entry("SYSENTER", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x35, 0x35,	entry("SYSEXIT", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x37, 0x37,	entry("GETSEC", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x40, 0x4F,	entry("CMOVCC", true, immediate::none, operand::full) },
+		{ map::two_byte,	0x50, 0x6F,	entry("SSE", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x70, 0x70,	entry("PSHUF", true, immediate::byte, operand::none) },
+		{ map::two_byte,	0x71, 0x73,	entry("PSHIFT", true, immediate::byte, operand::none) },
+		{ map::two_byte,	0x74, 0x76,	entry("PCMPEQ", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x77, 0x77,	entry("EMMS", false, immediate::none, operand::none) },
+		{ map::two_byte,	0x78, 0x78,	entry("VMREAD", true, immediate::none, operand::force_64) },
+		{ map::two_byte,	0x79, 0x79,	entry("VMWRITE", true, immediate::none, operand::force_64) },
+		{ map::two_byte,	0x7C, 0x7F,	entry("SSE", true, immediate::none, operand::none) },
+		{ map::two_byte,	0x80, 0x8F,	entry("JCC", false, immediate::full, operand::force_64, x86::dispatch::jump_conditional) },
+		{ map::two_byte,	0x90, 0x9F,	entry("SETCC", true, immediate::none, operand::byte) },
+		{ map::two_byte,	0xA0, 0xA0,	entry("PUSH", false, immediate::none, operand::default_64) },
+		{ map::two_byte,	0xA1, 0xA1,	entry("POP", false, immediate::none, operand::default_64) },
+		{ map::two_byte,	0xA2, 0xA2,	entry("CPUID", false, immediate::none, operand::none) },
+		{ map::two_byte,	0xA3, 0xA3,	entry("BT", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xA4, 0xA4,	entry("SHLD", true, immediate::byte, operand::full) },
+		{ map::two_byte,	0xA5, 0xA5,	entry("SHLD", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xA8, 0xA8,	entry("PUSH", false, immediate::none, operand::default_64) },
+		{ map::two_byte,	0xA9, 0xA9,	entry("POP", false, immediate::none, operand::default_64) },
+		{ map::two_byte,	0xAA, 0xAA,	entry("RSM", false, immediate::none, operand::none) },
+		{ map::two_byte,	0xAB, 0xAB,	entry("BTS", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xAC, 0xAC,	entry("SHRD", true, immediate::byte, operand::full) },
+		{ map::two_byte,	0xAD, 0xAD,	entry("SHRD", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xAE, 0xAE,	entry("GRP15", true, immediate::none, operand::none) },
+		{ map::two_byte,	0xAF, 0xAF,	entry("IMUL", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB0, 0xB0,	entry("CMPXCHG", true, immediate::none, operand::byte) },
+		{ map::two_byte,	0xB1, 0xB1,	entry("CMPXCHG", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB2, 0xB2,	entry("LSS", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB3, 0xB3,	entry("BTR", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB4, 0xB4,	entry("LFS", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB5, 0xB5,	entry("LGS", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB6, 0xB7,	entry("MOVZX", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB8, 0xB8,	entry("POPCNT", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xB9, 0xB9,	entry("UD1", true, immediate::none, operand::none) },
+		{ map::two_byte,	0xBA, 0xBA,	entry("GRP8", true, immediate::byte, operand::full) },
+		{ map::two_byte,	0xBB, 0xBB,	entry("BTC", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xBC, 0xBC,	entry("BSF", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xBD, 0xBD,	entry("BSR", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xBE, 0xBF,	entry("MOVSX", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xC0, 0xC0,	entry("XADD", true, immediate::none, operand::byte) },
+		{ map::two_byte,	0xC1, 0xC1,	entry("XADD", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xC2, 0xC2,	entry("CMPPS", true, immediate::byte, operand::none) },
+		{ map::two_byte,	0xC3, 0xC3,	entry("MOVNTI", true, immediate::none, operand::full) },
+		{ map::two_byte,	0xC4, 0xC6,	entry("SSE", true, immediate::byte, operand::none) },
+		{ map::two_byte,	0xC7, 0xC7,	entry("GRP9", true, immediate::none, operand::none) },
+		{ map::two_byte,	0xC8, 0xCF,	entry("BSWAP", false, immediate::none, operand::full) },
+		{ map::two_byte,	0xD0, 0xFE,	entry("SSE", true, immediate::none, operand::none) },
+		{ map::two_byte,	0xFF, 0xFF,	entry("UD0", true, immediate::none, operand::none) },
+
+		// 0F 38 XX
+		{ map::three_byte_38,	0x00, 0xFF,	entry("SSE", true, immediate::none, operand::none) },
+
+		// 0F 3A XX
+		{ map::three_byte_3a,	0x00, 0xFF,	entry("SSE", true, immediate::byte, operand::none) },
+
+		// GROUPS, INDEXED BY GROUP * 8 + MODRM.REG
+		{ map::group,	slot(group_1_byte, 0), slot(group_1_byte, 0),	entry("ADD", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 1), slot(group_1_byte, 1),	entry("OR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 2), slot(group_1_byte, 2),	entry("ADC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 3), slot(group_1_byte, 3),	entry("SBB", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 4), slot(group_1_byte, 4),	entry("AND", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 5), slot(group_1_byte, 5),	entry("SUB", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 6), slot(group_1_byte, 6),	entry("XOR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_byte, 7), slot(group_1_byte, 7),	entry("CMP", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 0), slot(group_1, 0),	entry("ADD", true, immediate::none, operand::none, x86::dispatch::add_displaced_destination, group_none, true) },
+		{ map::group,	slot(group_1, 1), slot(group_1, 1),	entry("OR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 2), slot(group_1, 2),	entry("ADC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 3), slot(group_1, 3),	entry("SBB", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 4), slot(group_1, 4),	entry("AND", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 5), slot(group_1, 5),	entry("SUB", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 6), slot(group_1, 6),	entry("XOR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1, 7), slot(group_1, 7),	entry("CMP", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 0), slot(group_1_sign_extended, 0),	entry("ADD", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 1), slot(group_1_sign_extended, 1),	entry("OR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 2), slot(group_1_sign_extended, 2),	entry("ADC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 3), slot(group_1_sign_extended, 3),	entry("SBB", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 4), slot(group_1_sign_extended, 4),	entry("AND", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 5), slot(group_1_sign_extended, 5),	entry("SUB", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 6), slot(group_1_sign_extended, 6),	entry("XOR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1_sign_extended, 7), slot(group_1_sign_extended, 7),	entry("CMP", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_1a, 0), slot(group_1a, 0),	entry("POP", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 0), slot(group_2, 0),	entry("ROL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 1), slot(group_2, 1),	entry("ROR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 2), slot(group_2, 2),	entry("RCL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 3), slot(group_2, 3),	entry("RCR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 4), slot(group_2, 4),	entry("SHL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 5), slot(group_2, 5),	entry("SHR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 6), slot(group_2, 6),	entry("SAL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_2, 7), slot(group_2, 7),	entry("SAR", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3_byte, 0), slot(group_3_byte, 0),	entry("TEST", true, immediate::byte, operand::none) },
+		{ map::group,	slot(group_3_byte, 1), slot(group_3_byte, 1),	entry("TEST", true, immediate::byte, operand::none) },
+		{ map::group,	slot(group_3_byte, 2), slot(group_3_byte, 2),	entry("NOT", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3_byte, 3), slot(group_3_byte, 3),	entry("NEG", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3_byte, 4), slot(group_3_byte, 4),	entry("MUL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3_byte, 5), slot(group_3_byte, 5),	entry("IMUL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3_byte, 6), slot(group_3_byte, 6),	entry("DIV", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3_byte, 7), slot(group_3_byte, 7),	entry("IDIV", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3, 0), slot(group_3, 0),	entry("TEST", true, immediate::full, operand::none) },
+		{ map::group,	slot(group_3, 1), slot(group_3, 1),	entry("TEST", true, immediate::full, operand::none) },
+		{ map::group,	slot(group_3, 2), slot(group_3, 2),	entry("NOT", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3, 3), slot(group_3, 3),	entry("NEG", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3, 4), slot(group_3, 4),	entry("MUL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3, 5), slot(group_3, 5),	entry("IMUL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3, 6), slot(group_3, 6),	entry("DIV", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_3, 7), slot(group_3, 7),	entry("IDIV", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_4, 0), slot(group_4, 0),	entry("INC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_4, 1), slot(group_4, 1),	entry("DEC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 0), slot(group_5, 0),	entry("INC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 1), slot(group_5, 1),	entry("DEC", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 2), slot(group_5, 2),	entry("CALL", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 3), slot(group_5, 3),	entry("CALLF", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 4), slot(group_5, 4),	entry("JMP", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 5), slot(group_5, 5),	entry("JMPF", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_5, 6), slot(group_5, 6),	entry("PUSH", true, immediate::none, operand::none) },
+		{ map::group,	slot(group_11, 0), slot(group_11, 0),	entry("MOV", true, immediate::none, operand::none) },
+
+	};
+
+
+	template <x86::spec::map Map, size_t N>
+	constexpr std::array<x86::spec::opcode_spec, N> expand()
+	{
+		std::array<x86::spec::opcode_spec, N> table{};
+
+		for (const auto& row : x86::spec::rows)
+		{
+			if (row.map != Map)
+				continue;
+
+			for (size_t i = row.first; i <= row.last; i++)
+				table[i] = row.spec;
+		}
+
+		return table;
+	}
+
+	inline constexpr auto one_byte = x86::spec::expand<x86::spec::map::one_byte, 0x100>();
+	inline constexpr auto two_byte = x86::spec::expand<x86::spec::map::two_byte, 0x100>();
+	inline constexpr auto three_byte_38 = x86::spec::expand<x86::spec::map::three_byte_38, 0x100>();
+	inline constexpr auto three_byte_3a = x86::spec::expand<x86::spec::map::three_byte_3a, 0x100>();
+	inline constexpr auto groups = x86::spec::expand<x86::spec::map::group, END_OF_GROUP * 8>();
+
+	static_assert(x86::spec::one_byte[x86::opcode::add_displaced_source].modrm);
+	static_assert(x86::spec::one_byte[x86::opcode::add_displaced_destination].group == group_1);
+	static_assert(!x86::spec::one_byte[0x0F].valid, "escape bytes are consumed by the opcode decoder");
+	static_assert(x86::spec::one_byte[0x8A].operand == operand::byte && x86::spec::one_byte[0x8B].operand == operand::full, "MOV r8, r/m8 is a byte operation");
+	static_assert(x86::spec::one_byte[0xA0].operand == operand::byte && x86::spec::one_byte[0xA2].operand == operand::byte, "MOV AL, moffs8 is a byte operation");
+
+
+	// ONE ARRAY INDEX PER DECODED OPCODE
+	inline const x86::spec::opcode_spec& find(const x86::opcode::buffer_t& opcode)
+	{
+		static constexpr x86::spec::opcode_spec invalid{};
+
+		switch (opcode.size())
+		{
+		case 1:
+			return x86::spec::one_byte[opcode.at(0)];
+
+		case 2:
+			return x86::spec::two_byte[opcode.at(1)];
+
+		case 3:
+			return opcode.at(1) == 0x38 ?
+				x86::spec::three_byte_38[opcode.at(2)] :
+				x86::spec::three_byte_3a[opcode.at(2)];
+		}
+
+		return invalid;
+	}
+
+	// VEX AND EVEX CARRY THEIR MAP IN THE PREFIX, EVEX MAPS 5 AND 6 HAVE NO LEGACY ESCAPE
+	inline const x86::spec::opcode_spec& find(x86::instruction& instr)
+	{
+		static constexpr x86::spec::opcode_spec invalid{};
+		static constexpr auto evex_only = x86::spec::entry("AVX512", true, immediate::none, operand::none);
+
+		if (instr.vex().has_value())
+		{
+			const auto& vex = instr.vex().value();
+			if (vex.map >= 1 && vex.map <= 3)
+				return x86::spec::find(instr.opcode().buffer());
+
+			return vex.size == 4 && (vex.map == 5 || vex.map == 6) ? evex_only : invalid;
+		}
+
+		return x86::spec::find(instr.opcode().buffer());
+	}
+
+	// EXTENSION ENTRY OF A GROUP OPCODE, OR THE SPEC ITSELF
+	inline const x86::spec::opcode_spec& extension(const x86::spec::opcode_spec& spec, std::uint8_t reg)
+	{
+		if (spec.group == group_none)
+			return spec;
+
+		return x86::spec::groups[x86::spec::slot(static_cast<x86::spec::group>(spec.group), reg)];
+	}
+
+
+	inline std::uint8_t operand_size(const x86::spec::opcode_spec& spec, bool wide, bool override)
+	{
+		switch (spec.operand)
+		{
+		case x86::spec::operand::byte:
+			return 1;
+
+		// REX.W WINS OVER THE OPERAND SIZE OVERRIDE
+		case x86::spec::operand::full:
+			return wide ? 8 : override ? 2 : 4;
+
+		case x86::spec::operand::default_64:
+			return override && !wide ? 2 : 8;
+
+		case x86::spec::operand::force_64:
+			return 8;
+
+		default:
+			return 0;
+		}
+	}
+
+	inline std::uint8_t operand_size(const x86::spec::opcode_spec& spec, x86::instruction& instr)
+	{
+		return x86::spec::operand_size(
+			spec,
+			instr.rex().has_value() && instr.rex().value().w,
+			instr.prefix().has(x86::prefix::OPERAND_SIZE_OVERRIDE));
+	}
+
+	inline std::uint8_t address_size(x86::instruction& instr)
+	{
+		return instr.prefix().has(x86::prefix::ADDRESS_SIZE_OVERRIDE) ? 4 : 8;
+	}
+
+	inline std::uint8_t immediate_size(x86::spec::immediate immediate, std::uint8_t operand_size, std::uint8_t address_size)
+	{
+		switch (immediate)
+		{
+		case x86::spec::immediate::byte:		return 1;
+		case x86::spec::immediate::word:		return 2;
+		case x86::spec::immediate::full:		return operand_size == 2 ? 2 : 4;
+		case x86::spec::immediate::variable:	return operand_size;
+		case x86::spec::immediate::word_byte:	return 3;
+		case x86::spec::immediate::offset:		return address_size;
+		default:								return 0;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// STD
+#include <cstdint>
+
+namespace x86
+{
+	// DECODED VEX (C5, C4) OR EVEX (62) PREFIX
+	// R, X, B AND W ARE FOLDED INTO THE INSTRUCTION'S REX SO REGISTER DECODING STAYS THE SAME
+	struct vex
+	{
+		// PREFIX BYTES INCLUDING THE ESCAPE: 2 OR 3 FOR VEX, 4 FOR EVEX
+		std::uint8_t size;
+
+		// 1 = 0F, 2 = 0F 38, 3 = 0F 3A, 5 AND 6 ARE EVEX ONLY
+		std::uint8_t map;
+
+		std::uint8_t vvvv : 4;		// EXTRA SOURCE REGISTER, ALREADY UN-INVERTED
+		std::uint8_t pp : 2;		// IMPLIED PREFIX: NONE, 66, F3, F2
+		std::uint8_t length : 2;	// 128, 256 OR 512 BITS
+
+		std::uint8_t opmask : 3;	// EVEX ONLY
+		std::uint8_t zeroing : 1;
+		std::uint8_t broadcast : 1;
+
+		
+		static constexpr bool is(std::uint8_t byte)
+		{
+			return byte == 0xC4 || byte == 0xC5 || byte == 0x62;
+		}
+	};
+}
@@ -0,0 +1,396 @@
+// STD
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// x86
+#include "length_decoder.hpp"
+#include "disasm.hpp"
+#include "instruction_spec.hpp"
+
+// VM
+// SRC/THREAD_POOL.HPP IS THE UNRELATED vm::thread_pool
+#include "core/thread_pool.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define X64VM_LENGTH_DECODER_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define X64VM_TARGET_AVX2
+#else
+#define X64VM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+	using byte_class = x86::length_decoder::byte_class;
+
+	// A BYTE'S CLASS IS LOW_NIBBLE[LO] & HIGH_NIBBLE[HI], EVERY CLASS IS A HIGH x LOW NIBBLE PRODUCT
+	constexpr std::array<std::uint8_t, 16> low_nibble = []()
+	{
+		std::array<std::uint8_t, 16> table{};
+
+		for (std::uint8_t i = 0; i < 16; i++)
+		{
+			if (i == 0x6 || i == 0xE)				table[i] |= byte_class::segment_prefix;
+			if (i >= 0x4 && i <= 0x7)				table[i] |= byte_class::size_prefix;
+			if (i == 0x0 || i == 0x2 || i == 0x3)	table[i] |= byte_class::lock_rep_prefix;
+			if (i == 0xF)							table[i] |= byte_class::escape;
+			if (i == 0x4 || i == 0x5)				table[i] |= byte_class::vex;
+			if (i == 0x2)							table[i] |= byte_class::evex;
+
+			table[i] |= byte_class::rex;
+		}
+
+		return table;
+	}();
+
+	constexpr std::array<std::uint8_t, 16> high_nibble = []()
+	{
+		std::array<std::uint8_t, 16> table{};
+
+		table[0x0] = byte_class::escape;
+		table[0x2] = byte_class::segment_prefix;
+		table[0x3] = byte_class::segment_prefix;
+		table[0x4] = byte_class::rex;
+		table[0x6] = byte_class::size_prefix | byte_class::evex;
+		table[0xC] = byte_class::vex;
+		table[0xF] = byte_class::lock_rep_prefix;
+
+		return table;
+	}();
+
+	constexpr std::array<std::uint8_t, 0x100> classes = []()
+	{
+		std::array<std::uint8_t, 0x100> table{};
+
+		for (size_t i = 0; i < table.size(); i++)
+			table[i] = low_nibble[i & 0xF] & high_nibble[i >> 4];
+
+		return table;
+	}();
+
+	static_assert(classes[0x66] == byte_class::size_prefix);
+	static_assert(classes[0x62] == byte_class::evex);
+	static_assert(classes[0x3F] == byte_class::plain);
+	static_assert(classes[0x0F] == byte_class::escape);
+
+	// MODRM + SIB + DISPLACEMENT BYTES, A SIB WITH BASE 101 UNDER MODE 0 ADDS ANOTHER FOUR
+	constexpr std::array<std::uint8_t, 0x100> modrm_length = []()
+	{
+		std::array<std::uint8_t, 0x100> table{};
+
+		for (size_t i = 0; i < table.size(); i++)
+		{
+			const auto mode = i >> 6;
+			const auto rm = i & 7;
+
+			std::uint8_t length = 1;
+			if (mode != 3 && rm == 4)
+				length += 1;
+
+			if (mode == 1)
+				length += 1;
+			else if (mode == 2 || (mode == 0 && rm == 5))
+				length += 4;
+
+			table[i] = length;
+		}
+
+		return table;
+	}();
+
+
+	// ZERO WHEN THE INSTRUCTION IS CUT OFF BY THE END OF THE REGION
+	size_t instruction_length(const std::uint8_t* code, const std::uint8_t* classes, size_t start, size_t size)
+	{
+		auto position = start;
+		bool operand_override = false;
+		bool address_override = false;
+		bool wide = false;
+
+
+		while (position < size && position - start < x86::disassembler::max_instruction_size - 1)
+		{
+			const auto current = classes[position];
+			if (current & byte_class::legacy_prefix)
+			{
+				operand_override |= code[position] == 0x66;
+				address_override |= code[position] == 0x67;
+				++position;
+				continue;
+			}
+
+			// A REX BYTE FOLLOWED BY ANOTHER PREFIX IS IGNORED
+			if ((current & byte_class::rex) && position + 1 < size && (classes[position + 1] & byte_class::legacy_prefix))
+			{
+				++position;
+				continue;
+			}
+
+			break;
+		}
+
+		if (position >= size)
+			return 0;
+
+
+		// VEX AND EVEX ARE RARE IN THE SWEEP, THE FULL DECODER HANDLES THEM
+		if (classes[position] & (byte_class::vex | byte_class::evex))
+		{
+			x86::instruction instr{};
+			auto pointer = const_cast<std::uint8_t*>(code + start);
+			if (!x86::disassembler::decode(instr, pointer, size - start))
+				return 0;
+
+			return instr.size();
+		}
+
+		if (classes[position] & byte_class::rex)
+		{
+			wide = (code[position] & 0x08) != 0;
+			++position;
+		}
+
+
+		const std::array<x86::spec::opcode_spec, 0x100>* table = &x86::spec::one_byte;
+		if (position < size && code[position] == 0x0F)
+		{
+			table = &x86::spec::two_byte;
+			++position;
+
+			if (position < size && (code[position] == 0x38 || code[position] == 0x3A))
+			{
+				table = code[position] == 0x38 ? &x86::spec::three_byte_38 : &x86::spec::three_byte_3a;
+				++position;
+			}
+		}
+
+		if (position >= size)
+			return 0;
+
+		const auto& spec = (*table)[code[position++]];
+
+		// MATCHES THE DECODER: AN UNDEFINED OPCODE CONSUMES NO OPERAND BYTES
+		if (!spec.valid)
+			return position - start;
+
+
+		size_t operand = 0;
+		auto immediate = spec.immediate;
+
+		if (spec.modrm)
+		{
+			if (position >= size)
+				return 0;
+
+			const auto modrm = code[position];
+			operand += modrm_length[modrm];
+
+			if ((modrm & 0xC7) == 0x04)
+			{
+				if (position + 1 >= size)
+					return 0;
+
+				if ((code[position + 1] & 7) == 5)
+					operand += 4;
+			}
+
+			if (immediate == x86::spec::immediate::none)
+				immediate = x86::spec::extension(spec, (modrm >> 3) & 7).immediate;
+		}
+
+		operand += x86::spec::immediate_size(
+			immediate,
+			x86::spec::operand_size(spec, wide, operand_override),
+			address_override ? 4 : 8);
+
+		return position - start + operand;
+	}
+}
+
+x86::length_map x86::length_decoder::scan(std::span<const std::uint8_t> code, size_t offset)
+{
+	x86::length_map map{};
+	map.starts.resize((code.size() + 63) / 64);
+	map.lengths.resize(code.size());
+
+	
+	std::vector<std::uint8_t> classes(code.size());
+	x86::length_decoder::classify(code, classes.data());
+
+	
+	for (auto position = offset; position < code.size();)
+	{
+		const auto length = instruction_length(code.data(), classes.data(), position, code.size());
+		if (length == 0 || position + length > code.size())
+			break;
+
+		map.starts[position / 64] |= std::uint64_t{ 1 } << (position % 64);
+		map.lengths[position] = static_cast<std::uint8_t>(length);
+
+		position += length;
+	}
+
+	return map;
+}
+
+x86::length_map x86::length_decoder::scan_parallel(std::span<const std::uint8_t> code, x64vm::core::ThreadPool& pool, size_t offset)
+{
+	if (offset >= code.size())
+		return x86::length_decoder::scan(code, offset);
+
+	
+	const auto region = code.size() - offset;
+	const auto chunk_count = std::min(pool.getThreadCount() * 4, region / x86::length_decoder::minimum_chunk_size);
+	if (chunk_count < 2)
+		return x86::length_decoder::scan(code, offset);
+
+	const auto chunk_size = (region + chunk_count - 1) / chunk_count;
+	const auto chunk_start = [&](size_t chunk) { return std::min(offset + chunk * chunk_size, code.size()); };
+
+
+	std::vector<std::uint8_t> classes(code.size());
+	std::vector<std::future<void>> pending{};
+
+	for (size_t chunk = 0; chunk < chunk_count; chunk++)
+	{
+		pending.push_back(pool.enqueue([&, chunk]()
+		{
+			const auto start = chunk_start(chunk);
+			x86::length_decoder::classify(code.subspan(start, chunk_start(chunk + 1) - start), classes.data() + start);
+		}));
+	}
+
+	for (auto& task : pending)
+		task.wait();
+	pending.clear();
+
+
+	// LENGTH AT EVERY OFFSET ANY SPECULATIVE STREAM VISITED, ZERO ELSEWHERE.
+	// A LENGTH ONLY DEPENDS ON ITS OFFSET, SO STREAMS THAT MEET SHARE EVERYTHING AFTER THAT POINT
+	std::vector<std::uint8_t> speculative(code.size());
+
+	for (size_t chunk = 0; chunk < chunk_count; chunk++)
+	{
+		pending.push_back(pool.enqueue([&, chunk]()
+		{
+			const auto start = chunk_start(chunk);
+			const auto end = chunk_start(chunk + 1);
+
+			// THE PREVIOUS CHUNK'S LAST INSTRUCTION CAN END ANYWHERE IN THE FIRST 15 BYTES
+			const auto candidates = chunk == 0 ? 1 : x86::disassembler::max_instruction_size;
+
+			for (size_t candidate = 0; candidate < candidates && start + candidate < end; candidate++)
+			{
+				// STOP AS SOON AS THIS STREAM RESYNCHRONISES WITH ONE ALREADY DECODED
+				for (auto position = start + candidate; position < end && speculative[position] == 0;)
+				{
+					const auto length = instruction_length(code.data(), classes.data(), position, code.size());
+					if (length == 0 || position + length > code.size())
+						break;
+
+					speculative[position] = static_cast<std::uint8_t>(length);
+					position += length;
+				}
+			}
+		}));
+	}
+
+	for (auto& task : pending)
+		task.wait();
+
+
+	// STITCH: FOLLOW THE ONE TRUE STREAM THROUGH THE PRECOMPUTED LENGTHS
+	x86::length_map map{};
+	map.starts.resize((code.size() + 63) / 64);
+	map.lengths.resize(code.size());
+
+	for (auto position = offset; position < code.size() && speculative[position] != 0;)
+	{
+		const auto length = speculative[position];
+
+		map.starts[position / 64] |= std::uint64_t{ 1 } << (position % 64);
+		map.lengths[position] = length;
+
+		position += length;
+	}
+
+	return map;
+}
+
+void x86::length_decoder::classify(std::span<const std::uint8_t> code, std::uint8_t* classes)
+{
+	if (x86::length_decoder::vectorised())
+		x86::length_decoder::classify_avx2(code.data(), code.size(), classes);
+	else
+		x86::length_decoder::classify_scalar(code.data(), code.size(), classes);
+}
+
+bool x86::length_decoder::vectorised()
+{
+#if defined(X64VM_LENGTH_DECODER_AVX2)
+	static const bool supported = []()
+	{
+#if defined(_MSC_VER)
+		// AVX2 IN CPUID AND YMM STATE ENABLED BY THE OS
+		int registers[4]{};
+		__cpuid(registers, 1);
+		const bool osxsave = (registers[2] & (1 << 27)) != 0;
+		if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(registers, 7, 0);
+		return (registers[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}();
+
+	return supported;
+#else
+	return false;
+#endif
+}
+
+void x86::length_decoder::classify_scalar(const std::uint8_t* code, size_t size, std::uint8_t* classes)
+{
+	for (size_t i = 0; i < size; i++)
+		classes[i] = ::classes[code[i]];
+}
+
+#if defined(X64VM_LENGTH_DECODER_AVX2)
+X64VM_TARGET_AVX2 void x86::length_decoder::classify_avx2(const std::uint8_t* code, size_t size, std::uint8_t* classes)
+{
+	const auto low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low_nibble.data())));
+	const auto high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(high_nibble.data())));
+	const auto nibble_mask = _mm256_set1_epi8(0x0F);
+
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(code + i));
+
+		// NO 8-BIT SHIFT, SHIFT WORDS AND MASK OFF WHAT CROSSED OVER
+		const auto low = _mm256_and_si256(bytes, nibble_mask);
+		const auto high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_mask);
+
+		const auto result = _mm256_and_si256(
+			_mm256_shuffle_epi8(low_table, low),
+			_mm256_shuffle_epi8(high_table, high));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(classes + i), result);
+	}
+
+	
+	x86::length_decoder::classify_scalar(code + i, size - i, classes + i);
+}
+#else
+void x86::length_decoder::classify_avx2(const std::uint8_t* code, size_t size, std::uint8_t* classes)
+{
+	x86::length_decoder::classify_scalar(code, size, classes);
+}
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace x64vm::core
+{
+	class ThreadPool;
+}
+
+namespace x86
+{
+	// INSTRUCTION BOUNDARIES OF A CODE REGION, FROM A LINEAR SWEEP
+	struct length_map
+	{
+		// BIT I IS SET WHEN AN INSTRUCTION STARTS AT OFFSET I
+		std::vector<std::uint64_t> starts;
+
+		// LENGTH OF THE INSTRUCTION STARTING AT OFFSET I, ZERO ELSEWHERE
+		std::vector<std::uint8_t> lengths;
+
+		bool is_start(size_t offset) const
+		{
+			return (this->starts[offset / 64] >> (offset % 64)) & 1;
+		}
+	};
+
+	// LENGTH-ONLY DECODER FOR PRE-SCANNING LARGE IMAGES. PREFIX, REX AND ESCAPE BYTES ARE
+	// CLASSIFIED 32 AT A TIME WITH AVX2 WHEN CPUID REPORTS IT, THE WALK THEN ONLY TOUCHES TABLES
+	class length_decoder
+	{
+	public:
+		// PER-BYTE CLASS BITS, A BYTE MAY ONLY CARRY ONE OF THEM
+		enum byte_class : std::uint8_t
+		{
+			plain = 0,
+			segment_prefix = 1 << 0,	// 26 2E 36 3E
+			size_prefix = 1 << 1,		// 64 65 66 67
+			lock_rep_prefix = 1 << 2,	// F0 F2 F3
+			rex = 1 << 3,				// 40-4F
+			escape = 1 << 4,			// 0F
+			vex = 1 << 5,				// C4 C5
+			evex = 1 << 6,				// 62
+
+			legacy_prefix = segment_prefix | size_prefix | lock_rep_prefix
+		};
+
+		// WHOLE REGION FROM OFFSET, STOPS AT THE FIRST INSTRUCTION THAT RUNS PAST THE END
+		static x86::length_map scan(std::span<const std::uint8_t> code, size_t offset = 0);
+
+		// SAME RESULT AS SCAN. CHUNKS ARE DECODED ON THE POOL FROM EVERY POSSIBLE ENTRY OFFSET
+		// AND STITCHED WHERE THE SPECULATIVE STREAMS JOIN THE ONE ARRIVING FROM THE PREVIOUS CHUNK
+		static x86::length_map scan_parallel(std::span<const std::uint8_t> code, x64vm::core::ThreadPool& pool, size_t offset = 0);
+
+		// CLASSIFY EVERY BYTE, CLASSES MUST HOLD CODE.SIZE() BYTES
+		static void classify(std::span<const std::uint8_t> code, std::uint8_t* classes);
+
+		// TRUE WHEN THE AVX2 CLASSIFIER WAS SELECTED AT RUNTIME
+		static bool vectorised();
+
+		// THE TWO IMPLEMENTATIONS CLASSIFY CHOOSES BETWEEN, PUBLIC SO THEY CAN BE CHECKED AGAINST EACH OTHER
+		// CLASSIFY_AVX2 MUST ONLY BE CALLED WHEN VECTORISED() IS TRUE
+		static void classify_scalar(const std::uint8_t* code, size_t size, std::uint8_t* classes);
+		static void classify_avx2(const std::uint8_t* code, size_t size, std::uint8_t* classes);
+
+	private:
+		static constexpr size_t minimum_chunk_size = 0x10000;
+	};
+}
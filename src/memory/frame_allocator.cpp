@@ -0,0 +1,162 @@
+// STD
+#include <cstring>
+#include <new>
+
+// VM
+#include "frame_allocator.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(_WIN32)
+std::uint8_t* vm::heap_backend::reserve(size_t size)
+{
+	// COMMITTED PAGES READ AS ZERO AND ONLY GET A PHYSICAL PAGE ON FIRST TOUCH, NOTHING TO CLEAR HERE
+	// VIRTUALALLOC ONLY ALIGNS TO 64 KIB: FIND AN ALIGNED HOLE, THEN CLAIM IT, RETRYING IF ANOTHER THREAD WON IT
+	for (size_t attempt = 0; attempt < 8; attempt++)
+	{
+		const auto region = VirtualAlloc(nullptr, size + vm::frame_allocator::slab_size, MEM_RESERVE, PAGE_NOACCESS);
+		if (region == nullptr)
+			break;
+
+		const auto start = reinterpret_cast<std::uintptr_t>(region);
+		const auto aligned = (start + vm::frame_allocator::slab_size - 1) & ~(vm::frame_allocator::slab_size - 1);
+		VirtualFree(region, 0, MEM_RELEASE);
+
+		if (const auto slab = VirtualAlloc(reinterpret_cast<void*>(aligned), size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE))
+			return static_cast<std::uint8_t*>(slab);
+	}
+
+	throw std::bad_alloc();
+}
+
+void vm::heap_backend::release(std::uint8_t* slab, size_t size [[maybe_unused]])
+{
+	VirtualFree(slab, 0, MEM_RELEASE);
+}
+#else
+std::uint8_t* vm::heap_backend::reserve(size_t size)
+{
+	// ANONYMOUS PAGES READ AS ZERO AND ONLY GET A PHYSICAL PAGE ON FIRST TOUCH, NOTHING TO CLEAR HERE
+	// OVER-RESERVE SO THE SLAB CAN START ON A SLAB BOUNDARY, THEN TRIM BOTH ENDS
+	const auto padded = size + vm::frame_allocator::slab_size;
+	const auto region = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (region == MAP_FAILED)
+		throw std::bad_alloc();
+
+	const auto start = reinterpret_cast<std::uintptr_t>(region);
+	const auto aligned = (start + vm::frame_allocator::slab_size - 1) & ~(vm::frame_allocator::slab_size - 1);
+
+	if (aligned != start)
+		munmap(region, aligned - start);
+
+	const auto tail = padded - (aligned - start) - size;
+	if (tail != 0)
+		munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+	return reinterpret_cast<std::uint8_t*>(aligned);
+}
+
+void vm::heap_backend::release(std::uint8_t* slab, size_t size)
+{
+	munmap(slab, size);
+}
+#endif
+
+vm::frame_allocator::frame_allocator() : frame_allocator(std::make_unique<vm::heap_backend>()) {}
+
+vm::frame_allocator::frame_allocator(std::unique_ptr<vm::frame_backend> backend) : m_backend(std::move(backend)) {}
+
+vm::frame_allocator::~frame_allocator()
+{
+	for (const auto slab : this->m_slabs)
+		this->m_backend->release(slab, vm::frame_allocator::slab_size);
+}
+
+std::uint8_t* vm::frame_allocator::allocate()
+{
+	std::uint8_t* frame = nullptr;
+	auto recycled = false;
+	{
+		std::lock_guard lock(this->m_lock);
+
+		if (!this->m_free.empty())
+		{
+			frame = this->m_free.back();
+			this->m_free.pop_back();
+			recycled = true;
+		}
+		else
+		{
+			if (this->m_cursor == this->m_slab_end)
+			{
+				const auto slab = this->m_backend->reserve(vm::frame_allocator::slab_size);
+				this->m_slabs.push_back(slab);
+
+				// SKIP THE HEADER FRAME, FRESH SLAB MEMORY IS ALREADY ZEROED BY THE BACKEND
+				this->m_cursor = slab + vm::frame_allocator::frame_size;
+				this->m_slab_end = slab + vm::frame_allocator::slab_size;
+			}
+
+			frame = this->m_cursor;
+			this->m_cursor += vm::frame_allocator::frame_size;
+		}
+
+		++this->m_in_use;
+	}
+
+	// RECYCLED FRAMES HOLD STALE GUEST DATA, CLEARING OUTSIDE THE LOCK
+	// FRESH FRAMES ARE LEFT UNTOUCHED SO THE HOST ONLY BACKS THEM ONCE THE GUEST WRITES
+	if (recycled)
+		std::memset(frame, 0, vm::frame_allocator::frame_size);
+
+	vm::frame_allocator::reference_count(frame).store(1, std::memory_order_relaxed);
+
+	return frame;
+}
+
+void vm::frame_allocator::share(std::uint8_t* frame)
+{
+	vm::frame_allocator::reference_count(frame).fetch_add(1, std::memory_order_relaxed);
+}
+
+void vm::frame_allocator::release(std::uint8_t* frame)
+{
+	// ACQ_REL SO THE LAST OWNER SEES EVERY OTHER OWNER'S WRITES BEFORE THE FRAME IS REUSED
+	if (vm::frame_allocator::reference_count(frame).fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	std::lock_guard lock(this->m_lock);
+	--this->m_in_use;
+	this->m_free.push_back(frame);
+}
+
+std::uint32_t vm::frame_allocator::references(std::uint8_t* frame)
+{
+	return vm::frame_allocator::reference_count(frame).load(std::memory_order_acquire);
+}
+
+std::uint8_t* vm::frame_allocator::zero_frame()
+{
+	std::call_once(this->m_zero_once, [this]()
+	{
+		this->m_zero_frame = this->allocate();
+	});
+
+	return this->m_zero_frame;
+}
+
+size_t vm::frame_allocator::slab_count()
+{
+	std::lock_guard lock(this->m_lock);
+	return this->m_slabs.size();
+}
+
+size_t vm::frame_allocator::frames_in_use()
+{
+	std::lock_guard lock(this->m_lock);
+	return this->m_in_use;
+}
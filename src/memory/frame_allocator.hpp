@@ -0,0 +1,91 @@
+#pragma once
+
+// STD
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vm
+{
+	// WHERE SLABS COME FROM, SWAPPED TO CHANGE HOW GUEST RAM IS BACKED ON THE HOST
+	class frame_backend
+	{
+	public:
+		virtual ~frame_backend() = default;
+
+		// SIZE IS A MULTIPLE OF THE SLAB SIZE, THE RESULT MUST BE SLAB ALIGNED AND ZEROED
+		virtual std::uint8_t* reserve(size_t size) = 0;
+		virtual void release(std::uint8_t* slab, size_t size) = 0;
+	};
+
+	// PLAIN ANONYMOUS HOST MEMORY, ALIGNED TO THE SLAB SIZE AND ZEROED BY THE OS
+	class heap_backend final : public vm::frame_backend
+	{
+	public:
+		std::uint8_t* reserve(size_t size) override;
+		void release(std::uint8_t* slab, size_t size) override;
+	};
+
+	// HANDS OUT 4 KIB GUEST PAGE FRAMES CARVED FROM LARGE SLABS
+	// FRAMES ARE REFERENCE COUNTED SO COPY-ON-WRITE CLONES CAN SHARE THEM, A FRAME IS RECYCLED
+	// WHEN ITS LAST REFERENCE IS RELEASED AND SLABS ARE ONLY RETURNED TO THE BACKEND ON DESTRUCTION
+	// SAFE TO SHARE BETWEEN VIRTUAL MACHINES RUNNING ON DIFFERENT THREADS
+	class frame_allocator
+	{
+	public:
+		static constexpr size_t frame_size = 0x1000;
+		static constexpr size_t slab_size = 0x200000;
+		static constexpr size_t frames_per_slab = slab_size / frame_size;
+
+		// THE FIRST FRAME OF EVERY SLAB HOLDS THE REFERENCE COUNTS OF THE OTHERS
+		static_assert(frames_per_slab * sizeof(std::uint32_t) <= frame_size, "reference counts must fit the header frame");
+
+		frame_allocator();
+		explicit frame_allocator(std::unique_ptr<vm::frame_backend> backend);
+		~frame_allocator();
+
+		frame_allocator(const frame_allocator&) = delete;
+		frame_allocator& operator=(const frame_allocator&) = delete;
+
+		// ZEROED FRAME WITH ONE REFERENCE, THROWS IF THE BACKEND IS OUT OF MEMORY
+		std::uint8_t* allocate();
+
+		// ADD A REFERENCE / DROP ONE, THE FRAME IS RECYCLED WHEN NONE ARE LEFT
+		void share(std::uint8_t* frame);
+		void release(std::uint8_t* frame);
+
+		std::uint32_t references(std::uint8_t* frame);
+
+		// SHARED READ-ONLY FRAME OF ZEROES BACKING DEMAND-ZERO PAGES, NEVER RECYCLED
+		std::uint8_t* zero_frame();
+
+		size_t slab_count();
+		size_t frames_in_use();
+
+	private:
+		static std::atomic_ref<std::uint32_t> reference_count(std::uint8_t* frame)
+		{
+			const auto address = reinterpret_cast<std::uintptr_t>(frame);
+			const auto slab = reinterpret_cast<std::uint32_t*>(address & ~(slab_size - 1));
+
+			return std::atomic_ref<std::uint32_t>(slab[(address & (slab_size - 1)) / frame_size]);
+		}
+
+		std::unique_ptr<vm::frame_backend> m_backend;
+
+		std::mutex m_lock;
+		std::vector<std::uint8_t*> m_slabs;
+		std::vector<std::uint8_t*> m_free;
+
+		// UNTOUCHED TAIL OF THE NEWEST SLAB
+		std::uint8_t* m_cursor = nullptr;
+		std::uint8_t* m_slab_end = nullptr;
+
+		size_t m_in_use = 0;
+
+		std::once_flag m_zero_once;
+		std::uint8_t* m_zero_frame = nullptr;
+	};
+}
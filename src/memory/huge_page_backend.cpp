@@ -0,0 +1,121 @@
+// STD
+#include <new>
+
+// VM
+#include "huge_page_backend.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+std::uint8_t* vm::huge_page_backend::reserve(size_t size)
+{
+	if (this->m_try_explicit)
+	{
+		if (const auto slab = this->reserve_explicit(size))
+		{
+			++this->m_explicit_slabs;
+			return slab;
+		}
+
+		this->m_try_explicit = false;
+	}
+
+	return this->reserve_transparent(size);
+}
+
+size_t vm::huge_page_backend::explicit_slabs()
+{
+	return this->m_explicit_slabs;
+}
+
+#if defined(_WIN32)
+std::uint8_t* vm::huge_page_backend::reserve_explicit(size_t size)
+{
+	// NEEDS SELOCKMEMORYPRIVILEGE, FAILS CLEANLY WITHOUT IT
+	const auto large_page = GetLargePageMinimum();
+	if (large_page == 0 || size % large_page != 0)
+		return nullptr;
+
+	return static_cast<std::uint8_t*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+}
+
+std::uint8_t* vm::huge_page_backend::reserve_transparent(size_t size)
+{
+	// WINDOWS HAS NO TRANSPARENT HUGE PAGES, PLAIN COMMITTED MEMORY IS STILL ONE CONTIGUOUS SLAB
+	// VIRTUALALLOC ONLY ALIGNS TO 64 KIB: FIND AN ALIGNED HOLE, THEN CLAIM IT, RETRYING IF ANOTHER THREAD WON IT
+	for (size_t attempt = 0; attempt < 8; attempt++)
+	{
+		const auto region = VirtualAlloc(nullptr, size + vm::huge_page_backend::huge_page_size, MEM_RESERVE, PAGE_NOACCESS);
+		if (region == nullptr)
+			break;
+
+		const auto start = reinterpret_cast<std::uintptr_t>(region);
+		const auto aligned = (start + vm::huge_page_backend::huge_page_size - 1) & ~(vm::huge_page_backend::huge_page_size - 1);
+		VirtualFree(region, 0, MEM_RELEASE);
+
+		if (const auto slab = VirtualAlloc(reinterpret_cast<void*>(aligned), size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE))
+			return static_cast<std::uint8_t*>(slab);
+	}
+
+	throw std::bad_alloc();
+}
+
+void vm::huge_page_backend::release(std::uint8_t* slab, size_t size [[maybe_unused]])
+{
+	VirtualFree(slab, 0, MEM_RELEASE);
+}
+#else
+std::uint8_t* vm::huge_page_backend::reserve_explicit(size_t size)
+{
+#if defined(MAP_HUGETLB)
+	// ONLY SUCCEEDS WHEN THE ADMINISTRATOR HAS RESERVED HUGE PAGES (VM.NR_HUGEPAGES)
+	auto flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_2MB)
+	// WITHOUT A SIZE THE KERNEL USES THE DEFAULT HUGE PAGE SIZE, WHICH MAY BE 1 GIB
+	flags |= MAP_HUGE_2MB;
+#endif
+
+	const auto slab = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (slab != MAP_FAILED)
+		return static_cast<std::uint8_t*>(slab);
+#endif
+
+	return nullptr;
+}
+
+std::uint8_t* vm::huge_page_backend::reserve_transparent(size_t size)
+{
+	// OVER-RESERVE SO THE SLAB CAN START ON A HUGE PAGE BOUNDARY, THEN TRIM BOTH ENDS
+	const auto padded = size + vm::huge_page_backend::huge_page_size;
+	const auto region = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (region == MAP_FAILED)
+		throw std::bad_alloc();
+
+	const auto start = reinterpret_cast<std::uintptr_t>(region);
+	const auto aligned = (start + vm::huge_page_backend::huge_page_size - 1) & ~(vm::huge_page_backend::huge_page_size - 1);
+
+	if (aligned != start)
+		munmap(region, aligned - start);
+
+	const auto tail = padded - (aligned - start) - size;
+	if (tail != 0)
+		munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+	const auto slab = reinterpret_cast<std::uint8_t*>(aligned);
+
+#if defined(MADV_HUGEPAGE)
+	// A HINT ONLY, KHUGEPAGED OR THE FAULT PATH DECIDES WHETHER THE SLAB REALLY GETS HUGE PAGES
+	madvise(slab, size, MADV_HUGEPAGE);
+#endif
+
+	return slab;
+}
+
+void vm::huge_page_backend::release(std::uint8_t* slab, size_t size)
+{
+	munmap(slab, size);
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+// STD
+#include <cstdint>
+
+// VM
+#include "frame_allocator.hpp"
+
+namespace vm
+{
+	// SLABS BACKED BY 2 MIB HOST PAGES, ONE HOST TLB ENTRY COVERS A WHOLE SLAB OF GUEST FRAMES
+	// TRIES EXPLICIT HUGE PAGES (MAP_HUGETLB / MEM_LARGE_PAGES) FIRST AND FALLS BACK TO
+	// 2 MIB ALIGNED ANONYMOUS MEMORY WITH A TRANSPARENT HUGE PAGE HINT
+	class huge_page_backend final : public vm::frame_backend
+	{
+	public:
+		static constexpr size_t huge_page_size = 0x200000;
+		// A HUGE PAGE IS EXACTLY ONE SLAB, SO HUGE PAGE ALIGNMENT IS THE SLAB ALIGNMENT THE ALLOCATOR NEEDS
+		static_assert(vm::frame_allocator::slab_size == huge_page_size, "slabs must be exactly one huge page");
+
+		std::uint8_t* reserve(size_t size) override;
+		void release(std::uint8_t* slab, size_t size) override;
+
+		// SLABS THAT GOT EXPLICIT HUGE PAGES RATHER THAN THE TRANSPARENT FALLBACK
+		size_t explicit_slabs();
+
+	private:
+		std::uint8_t* reserve_explicit(size_t size);
+		std::uint8_t* reserve_transparent(size_t size);
+
+		// CLEARED ON THE FIRST FAILURE, THE HOST POOL DOES NOT GROW ON ITS OWN
+		bool m_try_explicit = true;
+		size_t m_explicit_slabs = 0;
+	};
+}
@@ -0,0 +1,27 @@
+#include "page_table.hpp"
+
+vm::page_table::entry_t* vm::page_table::emplace(std::uint8_t* address)
+{
+	if (!vm::page_table::canonical(address))
+		return nullptr;
+
+	auto table = this->m_root.get();
+	for (size_t level = levels - 1; level > 0; level--)
+	{
+		auto& entry = table->entries[vm::page_table::index(address, level)];
+		if ((entry & present) == 0)
+		{
+			auto& next = this->m_tables.emplace_back(std::make_unique<vm::page_table::table>());
+			entry = reinterpret_cast<entry_t>(next.get()) | present;
+		}
+
+		table = reinterpret_cast<vm::page_table::table*>(entry & address_mask);
+	}
+
+	return &table->entries[vm::page_table::index(address, 0)];
+}
+
+size_t vm::page_table::table_count()
+{
+	return this->m_tables.size();
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+// STD
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vm
+{
+	// 4-LEVEL RADIX TREE MIRRORING X86-64 PAGING: PML4 -> PDPT -> PD -> PT, 9 ADDRESS BITS PER LEVEL
+	// LOOKUP IS ALWAYS FOUR DEPENDENT LOADS, A MAPPED PAGE COSTS ONE 8-BYTE ENTRY
+	class page_table
+	{
+	public:
+		using entry_t = std::uint64_t;
+
+		static constexpr size_t levels = 4;
+		static constexpr size_t entries_per_table = 0x200;
+
+		// LOW 12 BITS OF AN ENTRY ARE FLAGS, THE REST IS THE HOST ADDRESS OF THE FRAME OR NEXT TABLE
+		enum flag : entry_t
+		{
+			present = 1 << 0,
+			writable = 1 << 1,
+
+			// DECODED COPIES OF THE PAGE ARE CACHED, WRITES TAKE THE SELF-MODIFYING CODE PATH
+			code = 1 << 2,
+
+			// FRAME MAY BE SHARED WITH A CLONE, THE FIRST WRITE DUPLICATES IT
+			copy_on_write = 1 << 3,
+
+			// NEVER WRITTEN, MAPS THE ALLOCATOR'S ZERO FRAME WITHOUT HOLDING A REFERENCE
+			// ALWAYS SET TOGETHER WITH COPY_ON_WRITE SO THE FIRST WRITE MATERIALISES A PRIVATE FRAME
+			demand_zero = 1 << 4
+		};
+
+		static constexpr entry_t address_mask = ~entry_t{ 0xFFF };
+
+		page_table() = default;
+
+		page_table(const page_table&) = delete;
+		page_table& operator=(const page_table&) = delete;
+
+		// LEAF ENTRY FOR THE PAGE, NULLPTR IF AN INTERMEDIATE TABLE IS MISSING
+		entry_t* find(std::uint8_t* address)
+		{
+			if (!vm::page_table::canonical(address))
+				return nullptr;
+
+			auto table = this->m_root.get();
+			for (size_t level = levels - 1; level > 0; level--)
+			{
+				const auto entry = table->entries[vm::page_table::index(address, level)];
+				if ((entry & present) == 0)
+					return nullptr;
+
+				table = reinterpret_cast<vm::page_table::table*>(entry & address_mask);
+			}
+
+			return &table->entries[vm::page_table::index(address, 0)];
+		}
+
+		// LEAF ENTRY FOR THE PAGE, CREATING MISSING INTERMEDIATE TABLES, NULLPTR IF NOT CANONICAL
+		entry_t* emplace(std::uint8_t* address);
+
+		// REBUILD PARENT'S TREE IN THIS (EMPTY) TABLE, EVERY PRESENT LEAF OF PARENT IS PASSED TO
+		// LEAF(PARENT_ENTRY&), WHICH MAY ADJUST IT AND RETURNS THE CHILD'S ENTRY
+		// LEAF TABLES ARE VISITED WHOLE, SO THE COST IS PER MAPPED PAGE, NOT PER ADDRESS BIT
+		template <typename Leaf>
+		void copy_from(vm::page_table& parent, Leaf&& leaf)
+		{
+			this->copy_level(parent.m_root.get(), this->m_root.get(), levels - 1, leaf);
+		}
+
+		// BITS 63..47 ALL EQUAL, ANYTHING ELSE WOULD ALIAS ANOTHER PAGE IN THE TREE
+		static bool canonical(std::uint8_t* address)
+		{
+			const auto upper = reinterpret_cast<std::uint64_t>(address) >> 47;
+			return upper == 0 || upper == 0x1FFFF;
+		}
+
+		static std::uint8_t* frame(entry_t entry)
+		{
+			return reinterpret_cast<std::uint8_t*>(entry & address_mask);
+		}
+
+		// TABLES BELOW THE ROOT, EACH 4 KIB
+		size_t table_count();
+
+	private:
+		struct alignas(0x1000) table
+		{
+			std::array<entry_t, entries_per_table> entries{};
+		};
+
+		template <typename Leaf>
+		void copy_level(table* from, table* to, size_t level, Leaf& leaf)
+		{
+			for (size_t i = 0; i < entries_per_table; i++)
+			{
+				auto& entry = from->entries[i];
+				if ((entry & present) == 0)
+					continue;
+
+				if (level == 0)
+				{
+					to->entries[i] = leaf(entry);
+					continue;
+				}
+
+				auto& next = this->m_tables.emplace_back(std::make_unique<vm::page_table::table>());
+				to->entries[i] = reinterpret_cast<entry_t>(next.get()) | present;
+
+				this->copy_level(reinterpret_cast<vm::page_table::table*>(entry & address_mask), next.get(), level - 1, leaf);
+			}
+		}
+
+		static size_t index(std::uint8_t* address, size_t level)
+		{
+			return (reinterpret_cast<std::uint64_t>(address) >> (12 + 9 * level)) & (entries_per_table - 1);
+		}
+
+		// HEAP ALLOCATED SO THE PAGE TABLE ITSELF NEEDS NO 4 KIB ALIGNMENT
+		std::unique_ptr<table> m_root = std::make_unique<table>();
+		std::vector<std::unique_ptr<table>> m_tables;
+	};
+}
@@ -0,0 +1,196 @@
+// STD
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <system_error>
+
+// VM
+#include "shared_memory_backend.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+vm::shared_memory_backend::native_handle_t vm::shared_memory_backend::native_handle() const
+{
+#if defined(_WIN32)
+	return this->m_section;
+#else
+	return this->m_descriptor;
+#endif
+}
+
+std::uint64_t vm::shared_memory_backend::size()
+{
+	std::lock_guard lock(this->m_lock);
+	return this->m_size;
+}
+
+std::optional<std::uint64_t> vm::shared_memory_backend::offset_of(const std::uint8_t* host)
+{
+	std::lock_guard lock(this->m_lock);
+
+	for (const auto& slab : this->m_slabs)
+	{
+		if (host >= slab.host && host < slab.host + slab.size)
+			return slab.offset + static_cast<std::uint64_t>(host - slab.host);
+	}
+
+	return std::nullopt;
+}
+
+void vm::shared_memory_backend::release(std::uint8_t* slab, size_t size)
+{
+	{
+		std::lock_guard lock(this->m_lock);
+		std::erase_if(this->m_slabs, [slab](const slab_mapping& mapping) { return mapping.host == slab; });
+	}
+
+	// THE OBJECT KEEPS ITS SIZE, OFFSETS ARE NEVER REUSED SO AN EXTERNAL MAPPING CANNOT ALIAS A NEW SLAB
+#if defined(_WIN32)
+	static_cast<void>(size);
+	UnmapViewOfFile(slab);
+#else
+	munmap(slab, size);
+#endif
+}
+
+#if defined(_WIN32)
+vm::shared_memory_backend::shared_memory_backend() : shared_memory_backend(std::string{}) {}
+
+vm::shared_memory_backend::shared_memory_backend(const std::string& name)
+{
+	// SEC_RESERVE: THE CAPACITY COSTS ADDRESS SPACE ONLY, PAGES ARE COMMITTED SLAB BY SLAB
+	this->m_section = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE | SEC_RESERVE,
+		static_cast<DWORD>(section_capacity >> 32), static_cast<DWORD>(section_capacity), name.empty() ? nullptr : name.c_str());
+
+	if (this->m_section == nullptr)
+		throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "CreateFileMapping");
+}
+
+vm::shared_memory_backend::~shared_memory_backend()
+{
+	CloseHandle(this->m_section);
+}
+
+std::uint8_t* vm::shared_memory_backend::reserve(size_t size)
+{
+	std::lock_guard lock(this->m_lock);
+
+	const auto offset = this->m_size;
+	if (offset + size > section_capacity)
+		throw std::bad_alloc();
+
+	// SAME ALIGNED HOLE SEARCH AS THE HUGE PAGE BACKEND, MAPVIEWOFFILEEX ONLY ALIGNS TO 64 KIB
+	for (size_t attempt = 0; attempt < 8; attempt++)
+	{
+		const auto region = VirtualAlloc(nullptr, size + vm::frame_allocator::slab_size, MEM_RESERVE, PAGE_NOACCESS);
+		if (region == nullptr)
+			break;
+
+		const auto start = reinterpret_cast<std::uintptr_t>(region);
+		const auto aligned = (start + vm::frame_allocator::slab_size - 1) & ~(vm::frame_allocator::slab_size - 1);
+		VirtualFree(region, 0, MEM_RELEASE);
+
+		const auto view = MapViewOfFileEx(this->m_section, FILE_MAP_ALL_ACCESS, static_cast<DWORD>(offset >> 32),
+			static_cast<DWORD>(offset), size, reinterpret_cast<void*>(aligned));
+
+		if (view == nullptr)
+			continue;
+
+		// FRESHLY COMMITTED SECTION PAGES READ AS ZERO
+		if (VirtualAlloc(view, size, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+		{
+			UnmapViewOfFile(view);
+			break;
+		}
+
+		const auto slab = static_cast<std::uint8_t*>(view);
+		this->m_slabs.push_back(slab_mapping{ slab, offset, size });
+		this->m_size += size;
+
+		return slab;
+	}
+
+	throw std::bad_alloc();
+}
+#else
+vm::shared_memory_backend::shared_memory_backend()
+{
+#if defined(__linux__)
+	this->m_descriptor = memfd_create("x64vm-guest-ram", MFD_CLOEXEC);
+	if (this->m_descriptor < 0)
+		throw std::system_error(errno, std::generic_category(), "memfd_create");
+#else
+	// NO MEMFD: A POSIX SHARED MEMORY OBJECT UNLINKED STRAIGHT AWAY BEHAVES THE SAME
+	const auto name = "/x64vm-guest-ram-" + std::to_string(getpid()) + "-" + std::to_string(reinterpret_cast<std::uintptr_t>(this));
+	this->m_descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (this->m_descriptor < 0)
+		throw std::system_error(errno, std::generic_category(), "shm_open");
+
+	shm_unlink(name.c_str());
+#endif
+}
+
+vm::shared_memory_backend::shared_memory_backend(const std::string& name)
+{
+	// THE FILE IS TRUNCATED, GUEST RAM ALWAYS STARTS OUT ZEROED
+	this->m_descriptor = open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (this->m_descriptor < 0)
+		throw std::system_error(errno, std::generic_category(), "open " + name);
+}
+
+vm::shared_memory_backend::~shared_memory_backend()
+{
+	close(this->m_descriptor);
+}
+
+std::uint8_t* vm::shared_memory_backend::reserve(size_t size)
+{
+	std::lock_guard lock(this->m_lock);
+
+	// GROWING THE OBJECT ZERO-FILLS THE NEW RANGE
+	const auto offset = this->m_size;
+	if (ftruncate(this->m_descriptor, static_cast<off_t>(offset + size)) != 0)
+		throw std::bad_alloc();
+
+	// OVER-RESERVE AN INACCESSIBLE REGION SO THE SLAB CAN START ON A SLAB BOUNDARY, THEN MAP OVER IT
+	const auto padded = size + vm::frame_allocator::slab_size;
+	const auto region = mmap(nullptr, padded, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (region == MAP_FAILED)
+	{
+		static_cast<void>(ftruncate(this->m_descriptor, static_cast<off_t>(offset)));
+		throw std::bad_alloc();
+	}
+
+	const auto start = reinterpret_cast<std::uintptr_t>(region);
+	const auto aligned = (start + vm::frame_allocator::slab_size - 1) & ~(vm::frame_allocator::slab_size - 1);
+
+	const auto view = mmap(reinterpret_cast<void*>(aligned), size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+		this->m_descriptor, static_cast<off_t>(offset));
+
+	if (view == MAP_FAILED)
+	{
+		munmap(region, padded);
+		static_cast<void>(ftruncate(this->m_descriptor, static_cast<off_t>(offset)));
+		throw std::bad_alloc();
+	}
+
+	if (aligned != start)
+		munmap(region, aligned - start);
+
+	const auto tail = padded - (aligned - start) - size;
+	if (tail != 0)
+		munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+	const auto slab = static_cast<std::uint8_t*>(view);
+	this->m_slabs.push_back(slab_mapping{ slab, offset, size });
+	this->m_size += size;
+
+	return slab;
+}
+#endif
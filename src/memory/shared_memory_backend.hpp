@@ -0,0 +1,71 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// VM
+#include "frame_allocator.hpp"
+
+namespace vm
+{
+	// SLABS MAPPED SHARED FROM ONE GROWING MEMORY OBJECT, SO ANOTHER PROCESS CAN MAP THE SAME GUEST RAM
+	// WITHOUT COPYING IT THROUGH THE VM. EVERY SLAB IS A SLAB-SIZED WINDOW OF THE OBJECT AT A KNOWN OFFSET,
+	// THE FIRST FRAME OF EACH WINDOW IS THE ALLOCATOR'S REFERENCE COUNT HEADER
+	// POSIX: AN ANONYMOUS MEMFD, OR A FILE WHEN A PATH IS GIVEN
+	// WINDOWS: A PAGEFILE-BACKED SECTION, NAMED WHEN A NAME IS GIVEN SO OTHER PROCESSES CAN OPEN IT
+	class shared_memory_backend final : public vm::frame_backend
+	{
+	public:
+#if defined(_WIN32)
+		using native_handle_t = void*;
+
+		// SECTIONS CANNOT GROW, SO THE WHOLE RANGE IS RESERVED UP FRONT AND SLABS COMMIT INTO IT
+		static constexpr std::uint64_t section_capacity = 0x1000000000;
+#else
+		using native_handle_t = int;
+#endif
+
+		shared_memory_backend();
+		explicit shared_memory_backend(const std::string& name);
+		~shared_memory_backend() override;
+
+		shared_memory_backend(const shared_memory_backend&) = delete;
+		shared_memory_backend& operator=(const shared_memory_backend&) = delete;
+
+		std::uint8_t* reserve(size_t size) override;
+		void release(std::uint8_t* slab, size_t size) override;
+
+		// FD OR SECTION HANDLE TO PASS TO ANOTHER PROCESS, OWNED BY THE BACKEND
+		native_handle_t native_handle() const;
+
+		// BYTES OF THE OBJECT HANDED OUT AS SLABS SO FAR
+		std::uint64_t size();
+
+		// OFFSET INTO THE OBJECT OF A HOST ADDRESS INSIDE ONE OF OUR SLABS
+		// DEMAND-ZERO GUEST PAGES ALL SHARE THE ALLOCATOR'S ZERO FRAME, EXTERNAL WRITERS MUST LEAVE IT ALONE
+		std::optional<std::uint64_t> offset_of(const std::uint8_t* host);
+
+	private:
+		struct slab_mapping
+		{
+			std::uint8_t* host;
+			std::uint64_t offset;
+			size_t size;
+		};
+
+		// GUARDS THE SLAB LIST, OFFSET_OF MAY RUN ON ANOTHER THREAD WHILE THE ALLOCATOR GROWS
+		std::mutex m_lock;
+		std::vector<slab_mapping> m_slabs;
+		std::uint64_t m_size = 0;
+
+#if defined(_WIN32)
+		void* m_section = nullptr;
+#else
+		int m_descriptor = -1;
+#endif
+	};
+}
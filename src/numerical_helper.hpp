@@ -1,7 +1,36 @@
 #pragma once
 
+// STD
+#include <array>
+#include <cstdint>
+#include <limits>
+
 namespace numerical_helper
 {
+	// EVEN PARITY OF EVERY BYTE VALUE
+	inline constexpr std::array<std::uint8_t, 0x100> parity_table = []()
+	{
+		std::array<std::uint8_t, 0x100> table{};
+
+		for (size_t value = 0; value < table.size(); value++)
+		{
+			auto bits = value;
+			bits ^= bits >> 4;
+			bits ^= bits >> 2;
+			bits ^= bits >> 1;
+			table[value] = (bits & 0x01) == 0;
+		}
+
+		return table;
+	}();
+
+	// X86 PF: SET WHEN THE LOW BYTE HAS AN EVEN NUMBER OF SET BITS
+	template <class T>
+	__forceinline constexpr std::uint8_t parity(T value)
+	{
+		return numerical_helper::parity_table[static_cast<std::uint8_t>(value)];
+	}
+
 	template <class T>
 	__forceinline constexpr T round_to_multiple(T number, T alignment)
 	{
@@ -10,7 +10,7 @@ namespace vm
 
     void test_suite::add_test(const std::string& name, std::function<void()> test_func)
     {
-        m_tests[name] = test_case(name, test_func);
+        m_tests.insert_or_assign(name, test_case(name, test_func));
         m_total_tests++;
     }
 
@@ -53,6 +53,7 @@ public:
 		
 		global::console.log("Running virtual machine");
 		this->m_vm.run(0x00);
+		this->m_vm.trace().flush();
 		global::console.log_indented<1>("Finished");
 
 		this->print_registers();
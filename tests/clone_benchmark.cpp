@@ -0,0 +1,47 @@
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// VM
+#include "virtual_memory.hpp"
+
+// TIMES VIRTUAL_MEMORY::CLONE_FROM, THE PART OF VIRTUAL_MACHINE::CLONE THAT GROWS WITH THE GUEST
+// EVERY PAGE IS WRITTEN FIRST SO EACH ONE HOLDS A PRIVATE FRAME THE CLONE HAS TO SHARE
+int main()
+{
+	constexpr size_t guest_size = 16 << 20;
+	constexpr size_t runs = 100;
+
+	const auto base = reinterpret_cast<std::uint8_t*>(0x60000000);
+
+	vm::virtual_memory parent;
+	parent.allocate(base, guest_size);
+
+	for (size_t offset = 0; offset < guest_size; offset += vm::virtual_memory::page_size)
+	{
+		std::uint64_t value = offset;
+		parent.write(value, base + offset);
+	}
+
+	std::vector<double> samples;
+	samples.reserve(runs);
+
+	for (size_t run = 0; run < runs; run++)
+	{
+		vm::virtual_memory child;
+
+		const auto start = std::chrono::steady_clock::now();
+		child.clone_from(parent);
+		const auto end = std::chrono::steady_clock::now();
+
+		samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+	}
+
+	std::sort(samples.begin(), samples.end());
+	std::printf("[+] clone of %zu MiB (%zu pages): min %.1f us, median %.1f us, max %.1f us over %zu runs\n",
+		guest_size >> 20, guest_size / vm::virtual_memory::page_size, samples.front(), samples[runs / 2], samples.back(), runs);
+
+	return 0;
+}
@@ -0,0 +1,183 @@
+// STD
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// x86
+#include "disasm.hpp"
+#include "length_decoder.hpp"
+
+// VM
+#include "unit_tests.hpp"
+
+namespace
+{
+	struct sample
+	{
+		std::vector<std::uint8_t> bytes;
+		size_t length;
+	};
+
+	// PREFIXES, REX, EVERY ESCAPE, SIB AND RIP-RELATIVE FORMS, EVERY IMMEDIATE SIZE, VEX AND EVEX
+	const std::vector<sample> corpus = {
+		{ { 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 }, 10 },
+		{ { 0x66, 0x68, 0x34, 0x12 }, 4 },
+		{ { 0xE8, 1, 2, 3, 4 }, 5 },
+		{ { 0x66, 0xE8, 1, 2, 3, 4 }, 6 },
+		{ { 0xF6, 0xC0, 0x12 }, 3 },
+		{ { 0xF7, 0xC0, 1, 2, 3, 4 }, 6 },
+		{ { 0xF7, 0xD0 }, 2 },
+		{ { 0x66, 0x0F, 0x3A, 0x0F, 0xC1, 0x08 }, 6 },
+		{ { 0x66, 0x0F, 0x38, 0x00, 0xC1 }, 5 },
+		{ { 0xC8, 0x10, 0, 1 }, 4 },
+		{ { 0xA1, 1, 2, 3, 4, 5, 6, 7, 8 }, 9 },
+		{ { 0x67, 0xA1, 1, 2, 3, 4 }, 6 },
+		{ { 0x0F, 0x84, 1, 2, 3, 4 }, 6 },
+		{ { 0x66, 0x81, 0xC0, 1, 2 }, 5 },
+		{ { 0x49, 0x81, 0x81, 0x20, 0x04, 0, 0, 0x37, 0x13, 0, 0 }, 11 },
+		{ { 0x83, 0x45, 0x08, 0x01 }, 4 },
+		{ { 0xC3 }, 1 },
+		{ { 0x0F, 0xBA, 0xE0, 0x03 }, 4 },
+		{ { 0x48, 0x8B, 0x04, 0x24 }, 4 },
+		{ { 0x48, 0x8B, 0x44, 0x24, 0x08 }, 5 },
+		{ { 0x48, 0x8B, 0x84, 0x24, 1, 2, 3, 4 }, 8 },
+		{ { 0x8B, 0x04, 0x25, 1, 2, 3, 4 }, 7 },
+		{ { 0x48, 0x8B, 0x05, 1, 2, 3, 4 }, 7 },
+		{ { 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0, 0, 0, 0, 0 }, 11 },
+		{ { 0x66, 0x66, 0x66, 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0, 0, 0, 0, 0 }, 14 },
+		{ { 0x48, 0xC7, 0x44, 0x24, 0x08, 1, 2, 3, 4 }, 9 },
+		{ { 0xF7, 0x05, 1, 2, 3, 4, 5, 6, 7, 8 }, 10 },
+		{ { 0x40, 0x66, 0x90 }, 3 },
+		{ { 0xC5, 0xFC, 0x77 }, 3 },
+		{ { 0xC5, 0xFD, 0x6F, 0x04, 0x24 }, 5 },
+		{ { 0xC4, 0xE3, 0x7D, 0x0F, 0xC1, 0x08 }, 6 },
+		{ { 0xC4, 0xE2, 0x7D, 0x18, 0x05, 1, 2, 3, 4 }, 9 },
+		{ { 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x44, 0x24, 0x01 }, 8 },
+		{ { 0x62, 0xF3, 0x7D, 0x48, 0x03, 0xC1, 0x01 }, 7 },
+		{ { 0x62, 0xF5, 0x7C, 0x48, 0x58, 0xC1 }, 6 }
+	};
+
+	std::vector<std::uint8_t> corpus_stream()
+	{
+		std::vector<std::uint8_t> stream;
+		for (const auto& entry : corpus)
+			stream.insert(stream.end(), entry.bytes.begin(), entry.bytes.end());
+
+		return stream;
+	}
+
+	// SCALAR RESULT AGAINST THE AVX2 ONE FOR EVERY START ALIGNMENT, SO BOTH THE 32-BYTE LANES AND THE SCALAR TAIL ARE HIT
+	void assert_classifiers_agree(const std::vector<std::uint8_t>& code, const std::string& message)
+	{
+		for (size_t start = 0; start < 32 && start <= code.size(); start++)
+		{
+			const auto size = code.size() - start;
+			std::vector<std::uint8_t> scalar(size), vectorised(size);
+
+			x86::length_decoder::classify_scalar(code.data() + start, size, scalar.data());
+			x86::length_decoder::classify_avx2(code.data() + start, size, vectorised.data());
+
+			vm::assert_true(scalar == vectorised, message + " at offset " + std::to_string(start));
+		}
+	}
+
+	void classifiers_agree_on_every_byte()
+	{
+		if (!x86::length_decoder::vectorised())
+			return;
+
+		std::vector<std::uint8_t> code(0x100 * 3);
+		for (size_t i = 0; i < code.size(); i++)
+			code[i] = static_cast<std::uint8_t>(i);
+
+		assert_classifiers_agree(code, "every byte value");
+	}
+
+	void classifiers_agree_on_random_bytes()
+	{
+		if (!x86::length_decoder::vectorised())
+			return;
+
+		std::mt19937 random(0x1337);
+		for (const auto size : { 1, 31, 32, 33, 63, 64, 65, 0x1011 })
+		{
+			std::vector<std::uint8_t> code(size);
+			for (auto& byte : code)
+				byte = static_cast<std::uint8_t>(random());
+
+			assert_classifiers_agree(code, "random bytes, size " + std::to_string(size));
+		}
+	}
+
+	void classifiers_agree_on_code()
+	{
+		if (!x86::length_decoder::vectorised())
+			return;
+
+		assert_classifiers_agree(corpus_stream(), "instruction corpus");
+	}
+
+	void scan_matches_expected_lengths()
+	{
+		for (const auto& entry : corpus)
+		{
+			const auto map = x86::length_decoder::scan(entry.bytes);
+
+			vm::assert_true(map.is_start(0), "instruction start");
+			vm::assert_equal<size_t>(entry.length, map.lengths[0], "length of an instruction starting with " + std::to_string(entry.bytes[0]));
+		}
+	}
+
+	void scan_matches_decoder()
+	{
+		auto stream = corpus_stream();
+		const auto map = x86::length_decoder::scan(stream);
+
+		auto pointer = stream.data();
+		const auto end = stream.data() + stream.size();
+
+		while (pointer != end)
+		{
+			const auto offset = static_cast<size_t>(pointer - stream.data());
+
+			x86::instruction instr{};
+			vm::assert_true(x86::disassembler::decode(instr, pointer, static_cast<size_t>(end - pointer)), "decode at " + std::to_string(offset));
+
+			vm::assert_true(map.is_start(offset), "scan start at " + std::to_string(offset));
+			vm::assert_equal<size_t>(instr.size(), map.lengths[offset], "scan length at " + std::to_string(offset));
+		}
+	}
+
+	void scan_stops_at_truncated_instruction()
+	{
+		// MOV RAX, IMM64 WITH ITS LAST BYTE MISSING
+		const std::vector<std::uint8_t> code = { 0x90, 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7 };
+		const auto map = x86::length_decoder::scan(code);
+
+		vm::assert_true(map.is_start(0), "leading nop");
+		vm::assert_false(map.is_start(1), "cut off instruction is not recorded");
+	}
+}
+
+int main()
+{
+	auto& suite = vm::test_suite::get_instance();
+
+	suite.add_test("classifiers_agree_on_every_byte", classifiers_agree_on_every_byte);
+	suite.add_test("classifiers_agree_on_random_bytes", classifiers_agree_on_random_bytes);
+	suite.add_test("classifiers_agree_on_code", classifiers_agree_on_code);
+	suite.add_test("scan_matches_expected_lengths", scan_matches_expected_lengths);
+	suite.add_test("scan_matches_decoder", scan_matches_decoder);
+	suite.add_test("scan_stops_at_truncated_instruction", scan_stops_at_truncated_instruction);
+
+	suite.run_all();
+
+	if (!x86::length_decoder::vectorised())
+		std::printf("[!] no AVX2 on this host, the classifiers were not compared\n");
+
+	for (const auto& name : suite.get_failed_test_names())
+		std::printf("[!] %s failed\n", name.c_str());
+
+	std::printf("[+] %zu/%zu tests passed\n", suite.get_passed_tests(), suite.get_total_tests());
+	return suite.get_failed_tests() == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+// STD
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// VM
+#include "frame_allocator.hpp"
+#include "page_table.hpp"
+#include "unit_tests.hpp"
+#include "virtual_memory.hpp"
+
+namespace
+{
+	// GUEST ADDRESSES ARE ONLY KEYS INTO THE PAGE TABLE, NOTHING HERE IS HOST MEMORY
+	const auto base = reinterpret_cast<std::uint8_t*>(0x50000000);
+
+	void assert_fault(vm::fault_code expected, const vm::fault& fault, const std::string& message)
+	{
+		vm::assert_equal(static_cast<int>(expected), static_cast<int>(fault.code), message);
+	}
+
+	void page_table_sparse_mappings()
+	{
+		vm::page_table table;
+		const auto low = reinterpret_cast<std::uint8_t*>(0x1000);
+		const auto high = reinterpret_cast<std::uint8_t*>(0x7FFFFFFFF000);
+
+		vm::assert_null(table.find(low), "empty table resolves nothing");
+
+		*table.emplace(low) = 0x1000 | vm::page_table::present;
+		*table.emplace(high) = 0x2000 | vm::page_table::present;
+
+		vm::assert_true(*table.find(low) == (0x1000 | vm::page_table::present), "low leaf keeps its entry");
+		vm::assert_true(*table.find(high) == (0x2000 | vm::page_table::present), "high leaf keeps its entry");
+
+		// ONE PDPT, PD AND PT PER MAPPING, THEY SHARE NOTHING BELOW THE ROOT
+		vm::assert_equal<size_t>(6, table.table_count(), "intermediate tables");
+	}
+
+	void page_table_rejects_non_canonical()
+	{
+		vm::page_table table;
+		const auto address = reinterpret_cast<std::uint8_t*>(0x0000800000000000);
+
+		vm::assert_false(vm::page_table::canonical(address), "bit 47 set without the upper bits");
+		vm::assert_null(table.emplace(address), "emplace of a non-canonical address");
+		vm::assert_null(table.find(address), "find of a non-canonical address");
+	}
+
+	void frame_allocator_reference_counts()
+	{
+		vm::frame_allocator frames;
+
+		const auto frame = frames.allocate();
+		vm::assert_equal<std::uint32_t>(1, frames.references(frame), "fresh frame");
+		vm::assert_equal<size_t>(1, frames.frames_in_use(), "in use after allocate");
+
+		frames.share(frame);
+		vm::assert_equal<std::uint32_t>(2, frames.references(frame), "shared frame");
+
+		frames.release(frame);
+		vm::assert_equal<size_t>(1, frames.frames_in_use(), "one reference left");
+
+		std::memset(frame, 0xCC, vm::frame_allocator::frame_size);
+		frames.release(frame);
+		vm::assert_equal<size_t>(0, frames.frames_in_use(), "in use after the last release");
+
+		// THE FREE LIST IS LIFO, THE STALE FRAME COMES BACK AND MUST BE CLEARED
+		const auto recycled = frames.allocate();
+		vm::assert_true(recycled == frame, "released frame is reused");
+
+		const std::array<std::uint8_t, vm::frame_allocator::frame_size> zeroes{};
+		vm::assert_equal(0, std::memcmp(recycled, zeroes.data(), zeroes.size()), "recycled frame is zeroed");
+	}
+
+	void frame_allocator_slab_alignment()
+	{
+		vm::frame_allocator frames;
+
+		for (size_t i = 0; i < vm::frame_allocator::frames_per_slab; i++)
+		{
+			const auto frame = frames.allocate();
+			vm::assert_equal<std::uintptr_t>(0, reinterpret_cast<std::uintptr_t>(frame) & (vm::frame_allocator::frame_size - 1), "frame alignment");
+		}
+
+		// THE HEADER FRAME IS NOT HANDED OUT, SO ONE SLAB RUNS OUT A FRAME EARLY
+		vm::assert_equal<size_t>(2, frames.slab_count(), "slabs for a slab's worth of frames");
+	}
+
+	void memory_round_trip()
+	{
+		vm::virtual_memory memory;
+		vm::assert_true(memory.allocate(base, 0x3000), "allocate");
+		vm::assert_false(memory.allocate(base + 0x2000, 0x1000), "overlapping allocate");
+
+		std::uint64_t value = 0x1122334455667788;
+		assert_fault(vm::fault_code::none, memory.write(value, base + 0x1008), "write");
+
+		std::uint64_t read = 0;
+		assert_fault(vm::fault_code::none, memory.read(base + 0x1008, read), "read");
+		vm::assert_equal<std::uint64_t>(value, read, "value read back");
+
+		vm::assert_true(memory.free(base), "free");
+		vm::assert_false(memory.mapped(base + 0x1000), "page unmapped after free");
+		assert_fault(vm::fault_code::page_fault, memory.read(base + 0x1008, read), "read after free");
+	}
+
+	void memory_block_across_pages()
+	{
+		vm::virtual_memory memory;
+		memory.allocate(base, 0x3000);
+
+		std::vector<std::uint8_t> data(0x1800);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = static_cast<std::uint8_t>(i * 7);
+
+		assert_fault(vm::fault_code::none, memory.write_block(base + 0xC00, data.data(), data.size()), "write spanning three pages");
+
+		std::vector<std::uint8_t> read(data.size());
+		assert_fault(vm::fault_code::none, memory.read_block(base + 0xC00, read.data(), read.size()), "read spanning three pages");
+		vm::assert_true(read == data, "bytes read back");
+	}
+
+	void memory_write_straddling_unmapped_page()
+	{
+		vm::virtual_memory memory;
+		memory.allocate(base, 0x1000);
+
+		std::array<std::uint8_t, 0x10> before{};
+		before.fill(0xAA);
+		memory.write_block(base + 0xFF0, before.data(), before.size());
+
+		// LAST 4 BYTES OF THE MAPPED PAGE, THEN 4 BYTES OF THE UNMAPPED ONE
+		std::uint64_t value = 0x5555555555555555;
+		const auto fault = memory.write(value, base + 0xFFC);
+		assert_fault(vm::fault_code::page_fault, fault, "straddling write");
+		vm::assert_true(fault.address == base + 0x1000, "fault names the unmapped page");
+
+		std::array<std::uint8_t, 0x10> after{};
+		memory.read_block(base + 0xFF0, after.data(), after.size());
+		vm::assert_true(after == before, "mapped half left unchanged");
+
+		assert_fault(vm::fault_code::page_fault, memory.fill(base + 0x800, 0, 0x1000), "straddling fill");
+		memory.read_block(base + 0xFF0, after.data(), after.size());
+		vm::assert_true(after == before, "mapped half left unchanged by fill");
+	}
+
+	std::uint8_t* frame_of(vm::virtual_memory& memory, std::uint8_t* address)
+	{
+		return vm::page_table::frame(*memory.page_table().find(address));
+	}
+
+	void clone_shares_frames()
+	{
+		vm::virtual_memory parent;
+		parent.allocate(base, 0x4000);
+
+		for (size_t offset = 0; offset < 0x4000; offset += 0x1000)
+		{
+			std::uint64_t value = offset;
+			parent.write(value, base + offset);
+		}
+
+		const auto in_use = parent.frames().frames_in_use();
+
+		vm::virtual_memory child;
+		child.clone_from(parent);
+
+		// CLONING COPIES PAGE TABLE ENTRIES ONLY
+		vm::assert_equal<size_t>(in_use, parent.frames().frames_in_use(), "frames in use after clone");
+		vm::assert_true(frame_of(parent, base + 0x2000) == frame_of(child, base + 0x2000), "same frame on both sides");
+		vm::assert_equal<std::uint32_t>(2, parent.frames().references(frame_of(parent, base + 0x2000)), "shared frame references");
+
+		std::uint64_t value = 0;
+		child.read(base + 0x2000, value);
+		vm::assert_equal<std::uint64_t>(0x2000, value, "child reads the parent's data");
+	}
+
+	void clone_write_breaks_sharing()
+	{
+		vm::virtual_memory parent;
+		parent.allocate(base, 0x2000);
+
+		std::uint64_t original = 0x1111;
+		parent.write(original, base);
+		parent.write(original, base + 0x1000);
+
+		vm::virtual_memory child;
+		child.clone_from(parent);
+
+		const auto shared = frame_of(parent, base);
+		const auto in_use = parent.frames().frames_in_use();
+
+		std::uint64_t value = 0x2222;
+		assert_fault(vm::fault_code::none, child.write(value, base + 8), "child write");
+
+		vm::assert_true(frame_of(child, base) != shared, "child got a private frame");
+		vm::assert_true(frame_of(parent, base) == shared, "parent keeps the original frame");
+		vm::assert_equal<std::uint32_t>(1, parent.frames().references(shared), "original frame references");
+		vm::assert_equal<size_t>(in_use + 1, parent.frames().frames_in_use(), "one frame copied");
+
+		// THE COPY CARRIES THE REST OF THE PAGE
+		std::uint64_t read = 0;
+		child.read(base, read);
+		vm::assert_equal<std::uint64_t>(0x1111, read, "child keeps the copied bytes");
+
+		parent.read(base + 8, read);
+		vm::assert_equal<std::uint64_t>(0, read, "parent does not see the child's write");
+
+		value = 0x3333;
+		parent.write(value, base + 0x1000);
+		child.read(base + 0x1000, read);
+		vm::assert_equal<std::uint64_t>(0x1111, read, "child does not see the parent's write");
+	}
+
+	void clone_last_owner_writes_in_place()
+	{
+		vm::virtual_memory parent;
+		parent.allocate(base, 0x1000);
+
+		std::uint64_t value = 0x1111;
+		parent.write(value, base);
+
+		const auto frame = frame_of(parent, base);
+		{
+			vm::virtual_memory child;
+			child.clone_from(parent);
+		}
+
+		const auto in_use = parent.frames().frames_in_use();
+
+		value = 0x2222;
+		assert_fault(vm::fault_code::none, parent.write(value, base), "write after the clone is gone");
+		vm::assert_true(frame_of(parent, base) == frame, "frame reused without a copy");
+		vm::assert_equal<size_t>(in_use, parent.frames().frames_in_use(), "no frame copied");
+	}
+
+	void demand_zero_reads()
+	{
+		vm::virtual_memory memory;
+		memory.allocate(base, 0x40000);
+
+		// ONLY THE SHARED ZERO FRAME EXISTS, HOWEVER LARGE THE ALLOCATION
+		vm::assert_equal<size_t>(1, memory.frames().frames_in_use(), "frames in use after allocate");
+
+		std::uint64_t value = 1;
+		assert_fault(vm::fault_code::none, memory.read(base + 0x3FFF8, value), "read");
+		vm::assert_equal<std::uint64_t>(0, value, "untouched page reads zero");
+
+		std::vector<std::uint8_t> data(0x3000, 0xAA);
+		memory.read_block(base + 0x800, data.data(), data.size());
+		vm::assert_true(std::all_of(data.begin(), data.end(), [](std::uint8_t byte) { return byte == 0; }), "untouched pages read zero");
+
+		vm::assert_equal<size_t>(1, memory.frames().frames_in_use(), "reads allocate nothing");
+	}
+
+	void demand_zero_first_write()
+	{
+		vm::virtual_memory memory;
+		memory.allocate(base, 0x3000);
+
+		std::uint64_t value = 0x1234;
+		assert_fault(vm::fault_code::none, memory.write(value, base + 0x1010), "first write");
+		vm::assert_equal<size_t>(2, memory.frames().frames_in_use(), "first write allocates one frame");
+		vm::assert_true(frame_of(memory, base + 0x1000) != memory.frames().zero_frame(), "page left the zero frame");
+		vm::assert_true(frame_of(memory, base + 0x2000) == memory.frames().zero_frame(), "neighbour still on the zero frame");
+
+		std::array<std::uint8_t, 0x1000> page{};
+		memory.read_block(base + 0x1000, page.data(), page.size());
+		vm::assert_equal<std::uint8_t>(0x34, page[0x10], "written byte");
+		vm::assert_equal<size_t>(2, static_cast<size_t>(std::count_if(page.begin(), page.end(), [](std::uint8_t byte) { return byte != 0; })), "rest of the page is zero");
+
+		const std::array<std::uint8_t, vm::frame_allocator::frame_size> zeroes{};
+		vm::assert_equal(0, std::memcmp(memory.frames().zero_frame(), zeroes.data(), zeroes.size()), "zero frame untouched");
+
+		value = 0x5678;
+		memory.write(value, base + 0x1018);
+		vm::assert_equal<size_t>(2, memory.frames().frames_in_use(), "second write reuses the frame");
+
+		memory.free(base);
+		vm::assert_equal<size_t>(1, memory.frames().frames_in_use(), "free drops the private frame only");
+	}
+
+	void demand_zero_clone()
+	{
+		vm::virtual_memory parent;
+		parent.allocate(base, 0x2000);
+
+		vm::virtual_memory child;
+		child.clone_from(parent);
+		vm::assert_equal<size_t>(1, parent.frames().frames_in_use(), "clone of untouched pages allocates nothing");
+
+		std::uint64_t value = 0x1234;
+		child.write(value, base);
+
+		std::uint64_t read = 1;
+		parent.read(base, read);
+		vm::assert_equal<std::uint64_t>(0, read, "parent still reads zero");
+		vm::assert_true(frame_of(parent, base) == parent.frames().zero_frame(), "parent still on the zero frame");
+	}
+}
+
+int main()
+{
+	auto& suite = vm::test_suite::get_instance();
+
+	suite.add_test("page_table_sparse_mappings", page_table_sparse_mappings);
+	suite.add_test("page_table_rejects_non_canonical", page_table_rejects_non_canonical);
+	suite.add_test("frame_allocator_reference_counts", frame_allocator_reference_counts);
+	suite.add_test("frame_allocator_slab_alignment", frame_allocator_slab_alignment);
+	suite.add_test("memory_round_trip", memory_round_trip);
+	suite.add_test("memory_block_across_pages", memory_block_across_pages);
+	suite.add_test("memory_write_straddling_unmapped_page", memory_write_straddling_unmapped_page);
+	suite.add_test("clone_shares_frames", clone_shares_frames);
+	suite.add_test("clone_write_breaks_sharing", clone_write_breaks_sharing);
+	suite.add_test("clone_last_owner_writes_in_place", clone_last_owner_writes_in_place);
+	suite.add_test("demand_zero_reads", demand_zero_reads);
+	suite.add_test("demand_zero_first_write", demand_zero_first_write);
+	suite.add_test("demand_zero_clone", demand_zero_clone);
+
+	suite.run_all();
+
+	for (const auto& name : suite.get_failed_test_names())
+		std::printf("[!] %s failed\n", name.c_str());
+
+	std::printf("[+] %zu/%zu tests passed\n", suite.get_passed_tests(), suite.get_total_tests());
+	return suite.get_failed_tests() == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// STD
+#include <cstdio>
+#include <cstring>
+
+// VM
+#include "unit_tests.hpp"
+#include "virtual_machine.hpp"
+
+namespace
+{
+	// GUEST MEMORY MAPPED OVER THE CODE NEEDS THE CODE BYTES COPIED IN, OR THE VM DECODES ZEROES
+	struct guest_page
+	{
+		alignas(vm::virtual_memory::page_size) std::uint8_t bytes[vm::virtual_memory::page_size];
+	};
+
+	void reset_registers(virtual_machine& machine)
+	{
+		for (std::uint8_t i = 0; i < 16; i++)
+			machine.context().get(i).qword = 0;
+	}
+
+	void map_code(virtual_machine& machine, guest_page& page, size_t size)
+	{
+		vm::assert_true(machine.memory().allocate(page.bytes, sizeof(page.bytes)), "allocate the code page");
+		vm::assert_false(static_cast<bool>(machine.memory().write_block(page.bytes, page.bytes, size)), "copy the code in");
+	}
+
+	void call_with_stack_on_code_page()
+	{
+		// 0: CALL 7 / 5: JMP 8 / 7: RET
+		static guest_page page{ { 0xE8, 0x02, 0x00, 0x00, 0x00, 0xEB, 0x01, 0xC3 } };
+		constexpr size_t size = 8;
+
+		virtual_machine machine(vm::code_view(page.bytes, size));
+		reset_registers(machine);
+		map_code(machine, page, size);
+
+		// THE RETURN ADDRESS PUSH LANDS ON THE PAGE THE RUNNING BLOCK WAS DECODED FROM AND DROPS IT
+		const auto stack = page.bytes + 0x800;
+		machine.context().get(x86::registr::id::rsp).ptr = stack;
+
+		const auto state = machine.run(0);
+		vm::assert_equal(static_cast<int>(vm::run_status::finished), static_cast<int>(state.status), "run status");
+		vm::assert_true(machine.context().get(x86::registr::id::rsp).ptr == stack, "stack balanced after the return");
+
+		std::uint64_t return_address = 0;
+		machine.memory().read(stack - sizeof(return_address), return_address);
+		vm::assert_true(return_address == reinterpret_cast<std::uint64_t>(page.bytes + 5), "return address on the code page");
+	}
+
+	void code_write_invalidates_blocks()
+	{
+		// ADD RBX, 1
+		static guest_page page{ { 0x48, 0x81, 0xC3, 0x01, 0x00, 0x00, 0x00 } };
+		constexpr size_t size = 7;
+
+		virtual_machine machine(vm::code_view(page.bytes, size));
+		reset_registers(machine);
+		map_code(machine, page, size);
+
+		machine.run(0);
+		vm::assert_equal<std::uint64_t>(1, machine.context().get(x86::registr::id::rbx).qword, "rbx after the first run");
+
+		// PATCH THE IMMEDIATE TO 5 THROUGH GUEST MEMORY
+		std::uint8_t immediate = 5;
+		machine.memory().write(immediate, page.bytes + 3);
+		vm::assert_equal<std::uint32_t>(1, machine.memory().generation(page.bytes), "code page generation");
+		vm::assert_equal<size_t>(0, machine.blocks().size(), "blocks after the write");
+
+		machine.run(0);
+		vm::assert_equal<std::uint64_t>(6, machine.context().get(x86::registr::id::rbx).qword, "rbx after the patched run");
+		vm::assert_equal(std::uint8_t{ 0x01 }, page.bytes[3], "host copy of the code untouched");
+	}
+
+	void reallocated_code_page_is_decoded_again()
+	{
+		// JMP 2, WHICH IS THE END OF THE CODE
+		static guest_page page{ { 0xEB, 0x00 } };
+		constexpr size_t size = 2;
+
+		virtual_machine machine(vm::code_view(page.bytes, size));
+		reset_registers(machine);
+		map_code(machine, page, size);
+
+		vm::assert_equal(static_cast<int>(vm::run_status::finished), static_cast<int>(machine.run(0).status), "first run");
+		vm::assert_equal<size_t>(1, machine.blocks().size(), "blocks after the first run");
+
+		// SAME RANGE, NEW CODE: JMP TO ITSELF
+		vm::assert_true(machine.memory().free(page.bytes), "free the code page");
+		vm::assert_equal<size_t>(0, machine.blocks().size(), "blocks after free");
+
+		const std::uint8_t loop[] = { 0xEB, 0xFE };
+		vm::assert_true(machine.memory().allocate(page.bytes, sizeof(page.bytes)), "allocate the code page again");
+		machine.memory().write_block(page.bytes, loop, sizeof(loop));
+
+		machine.enter(0);
+		vm::assert_equal(static_cast<int>(vm::run_status::suspended), static_cast<int>(machine.run_for(100).status), "new code runs");
+	}
+
+	void branch_outside_code_faults()
+	{
+		// JMP 0x12, PAST THE END OF THE CODE
+		static std::uint8_t code[] = { 0xEB, 0x10 };
+
+		virtual_machine machine(code);
+		reset_registers(machine);
+
+		// WITHOUT A HANDLER THE FAULT IS LOGGED AND SKIPPED
+		size_t faults = 0;
+		machine.set_fault_handler([&faults](virtual_machine&, const vm::fault&)
+		{
+			++faults;
+			return vm::fault_action::stop;
+		});
+
+		const auto state = machine.run(0);
+		vm::assert_equal<size_t>(1, faults, "handler calls");
+		vm::assert_equal(static_cast<int>(vm::run_status::faulted), static_cast<int>(state.status), "run status");
+		vm::assert_equal(static_cast<int>(vm::fault_code::invalid_target), static_cast<int>(machine.last_fault().code), "fault code");
+		vm::assert_true(machine.last_fault().address == code + 0x12, "fault names the target");
+		vm::assert_true(machine.last_fault().instruction == code, "fault names the jump");
+		vm::assert_true(machine.context().instruction_pointer() == code, "stopped at the jump");
+	}
+
+	void chained_loop_runs_in_slices()
+	{
+		// 0: ADD RBX, 1 / 7: JMP 0
+		static std::uint8_t code[] = { 0x48, 0x81, 0xC3, 0x01, 0x00, 0x00, 0x00, 0xEB, 0xF7 };
+
+		virtual_machine machine(code);
+		reset_registers(machine);
+		machine.enter(0);
+
+		std::uint64_t instructions = 0;
+		for (size_t slice = 0; slice < 10; slice++)
+		{
+			const auto state = machine.run_for(1000);
+			vm::assert_equal(static_cast<int>(vm::run_status::suspended), static_cast<int>(state.status), "slice status");
+			instructions += state.instructions;
+		}
+
+		// ONE ADD PER TWO-INSTRUCTION ITERATION, AND SLICES ONLY END BETWEEN BLOCKS
+		vm::assert_equal<std::uint64_t>(instructions / 2, machine.context().get(x86::registr::id::rbx).qword, "iterations");
+		vm::assert_equal<size_t>(1, machine.blocks().size(), "the loop is one block");
+	}
+}
+
+int main()
+{
+	auto& suite = vm::test_suite::get_instance();
+
+	suite.add_test("branch_outside_code_faults", branch_outside_code_faults);
+	suite.add_test("chained_loop_runs_in_slices", chained_loop_runs_in_slices);
+	suite.add_test("call_with_stack_on_code_page", call_with_stack_on_code_page);
+	suite.add_test("code_write_invalidates_blocks", code_write_invalidates_blocks);
+	suite.add_test("reallocated_code_page_is_decoded_again", reallocated_code_page_is_decoded_again);
+
+	suite.run_all();
+
+	for (const auto& name : suite.get_failed_test_names())
+		std::printf("[!] %s failed\n", name.c_str());
+
+	std::printf("[+] %zu/%zu tests passed\n", suite.get_passed_tests(), suite.get_total_tests());
+	return suite.get_failed_tests() == 0 ? 0 : 1;
+}